@@ -24,8 +24,31 @@ extern "C" {
 #define LOTTIE_ERR_IO      -3   /* IO error */
 #define LOTTIE_ERR_PARSE   -4   /* Parse error */
 
+/* Rasterizer backends */
+#define LOTTIE_RASTER_GRAY   0  /* FreeType gray raster */
+#define LOTTIE_RASTER_ACCUM  1  /* Signed area accumulation raster */
+
+/* Easing evaluation modes */
+#define LOTTIE_EASING_EXACT  0  /* Solve the easing curve per evaluation */
+#define LOTTIE_EASING_TABLE  1  /* 256 entry lookup table */
+
+/* Image asset decoding */
+#define LOTTIE_IMAGE_DECODE_LAZY      0  /* Decode on first draw */
+#define LOTTIE_IMAGE_DECODE_PARALLEL  1  /* Decode all images at load, multi-threaded */
+
+/* Render quality (curve flattening tolerance) */
+#define LOTTIE_QUALITY_AUTO    0  /* Same as NORMAL */
+#define LOTTIE_QUALITY_HIGH    1  /* 1/4 pixel */
+#define LOTTIE_QUALITY_NORMAL  2  /* 1/2 pixel */
+#define LOTTIE_QUALITY_FAST    3  /* 1 pixel */
+
+/* Sampling of scaled or rotated image layers */
+#define LOTTIE_IMAGE_FILTER_NEAREST   0  /* Closest texel, fastest */
+#define LOTTIE_IMAGE_FILTER_BILINEAR  1  /* Weighted four texels, smooth */
+
 /* Opaque handle type */
 typedef struct LottieAnimation* LottieAnimationHandle;
+typedef struct LottieParser* LottieParserHandle;
 
 /* Surface structure - render target */
 typedef struct {
@@ -44,6 +67,42 @@ typedef struct {
     size_t height;          /* Default height */
 } LottieAnimationInfo;
 
+/* Content summary, for predicting render cost */
+typedef struct {
+    size_t layerCount;          /* Drawn layers, nested ones included */
+    size_t shapeLayerCount;
+    size_t precompLayerCount;
+    size_t imageLayerCount;
+    size_t solidLayerCount;
+    size_t staticLayerCount;    /* Layers whose content never changes */
+    size_t hiddenLayerCount;    /* Layers that are never drawn */
+    size_t matteLayerCount;     /* Layers drawn through a track matte */
+    size_t maskLayerCount;      /* Layers with masks */
+    size_t offscreenLayerCount; /* Layers that may need an offscreen surface */
+    size_t maxPathPoints;       /* Points in the largest path */
+    size_t pathCount;           /* Paths in the resource */
+    size_t uniquePathCount;     /* Distinct paths kept in memory */
+    size_t sharedPathBytes;     /* Path point data shared instead of copied */
+    size_t activeInFrame;       /* First frame with visible content */
+    size_t activeOutFrame;      /* Last frame with visible content */
+    int    hasContent;          /* 0 if no frame draws anything */
+    int    isStatic;            /* 1 if every frame renders the same */
+} LottieAnimationStats;
+
+/* Offscreen surface pool counters */
+typedef struct {
+    size_t allocations;     /* Surfaces that needed a new buffer */
+    size_t reuses;          /* Surfaces served from the pool */
+    size_t retainedBytes;   /* Free buffers kept for reuse */
+    size_t peakBytes;       /* Most surface memory, in use and free */
+} LottieSurfaceCacheStats;
+
+/* Counters of the last rendered frame */
+typedef struct {
+    size_t drawnLayerCount;     /* Visible layers that were drawn */
+    size_t culledLayerCount;    /* Visible layers hidden by opaque ones */
+} LottieRenderStats;
+
 /* ========== Loading Functions ========== */
 
 /**
@@ -66,6 +125,36 @@ LottieAnimationHandle lottie_animation_from_data(
     const char* resourcePath
 );
 
+/**
+ * Start an incremental load. JSON data is fed in chunks as it arrives
+ * (e.g. from the network) and parsed while feeding.
+ * @param resourcePath Resource path for external images, can be NULL
+ * @return Parser handle, NULL on failure
+ */
+LottieParserHandle lottie_parser_create(const char* resourcePath);
+
+/**
+ * Feed the next chunk of JSON data
+ * @param parser Parser handle
+ * @param data Chunk data (copied before returning)
+ * @param size Chunk length
+ * @return LOTTIE_OK on success, error code otherwise
+ */
+int lottie_parser_feed(LottieParserHandle parser, const char* data, size_t size);
+
+/**
+ * End of data: build the animation and release the parser
+ * @param parser Parser handle (invalid after this call)
+ * @return Animation handle, NULL on failure
+ */
+LottieAnimationHandle lottie_parser_finish(LottieParserHandle parser);
+
+/**
+ * Abort an incremental load and release the parser
+ * @param parser Parser handle (can be NULL)
+ */
+void lottie_parser_destroy(LottieParserHandle parser);
+
 /* ========== Info Query ========== */
 
 /**
@@ -113,6 +202,20 @@ int lottie_animation_get_size(
     size_t* height
 );
 
+/**
+ * Get a summary of the animation content (computed once at load time)
+ * @param handle Animation handle
+ * @param stats Output stats structure
+ * @return LOTTIE_OK on success, error code otherwise
+ * @note Frames outside [activeInFrame, activeOutFrame] render empty.
+ *       Layers of a precomposition used several times are counted
+ *       once per use.
+ */
+int lottie_animation_get_stats(
+    LottieAnimationHandle handle,
+    LottieAnimationStats* stats
+);
+
 /* ========== Rendering Functions ========== */
 
 /**
@@ -130,6 +233,38 @@ int lottie_animation_render(
     int keepAspectRatio
 );
 
+/**
+ * Render the animation at a point in time synchronously
+ * @param handle Animation handle
+ * @param seconds Time from the start of the animation, clamped to the duration
+ * @param surface Render target surface
+ * @param keepAspectRatio 0 = stretch fill, 1 = keep aspect ratio
+ * @return LOTTIE_OK on success, error code otherwise
+ * @note Keyframes are interpolated between frames, e.g. a 30 fps animation
+ *       can be drawn at 120 Hz without repeating frames. Layers with time
+ *       remapping or time stretch still advance on whole frames.
+ */
+int lottie_animation_render_time(
+    LottieAnimationHandle handle,
+    double seconds,
+    LottieSurface* surface,
+    int keepAspectRatio
+);
+
+/**
+ * Get the layer counters of the last rendered frame
+ * @param handle Animation handle
+ * @param stats Output counters
+ * @return LOTTIE_OK on success, LOTTIE_ERR_NULL if handle or stats is NULL
+ * @note Layers entirely beneath an opaque solid, shape or image layer are
+ *       not blended, they are counted as culled. Without LOTTIE_THREAD
+ *       they are not rasterized either.
+ */
+int lottie_animation_get_render_stats(
+    LottieAnimationHandle handle,
+    LottieRenderStats* stats
+);
+
 /**
  * Get frame number at position
  * @param handle Animation handle
@@ -141,6 +276,50 @@ size_t lottie_animation_frame_at_pos(
     double pos
 );
 
+/**
+ * Set the render quality of an animation
+ * @param handle Animation handle
+ * @param quality One of LOTTIE_QUALITY_*
+ * @return LOTTIE_OK on success, LOTTIE_ERR_INVALID for unknown quality
+ * @note The tolerance is in output pixels at any render size. Default
+ *       is LOTTIE_QUALITY_AUTO, the same as LOTTIE_QUALITY_NORMAL
+ */
+int lottie_animation_set_quality(
+    LottieAnimationHandle handle,
+    int quality
+);
+
+/**
+ * Set how image layers are sampled when scaled or rotated
+ * @param handle Animation handle
+ * @param filter One of LOTTIE_IMAGE_FILTER_*
+ * @return LOTTIE_OK on success, LOTTIE_ERR_INVALID for unknown filter
+ * @note Default is LOTTIE_IMAGE_FILTER_NEAREST. Bilinear is smoother but
+ *       costs more; images drawn at their natural size are copied either
+ *       way.
+ */
+int lottie_animation_set_image_filter(
+    LottieAnimationHandle handle,
+    int filter
+);
+
+/**
+ * Pre-evaluate every animated property for every frame ("baked timeline")
+ * @param handle Animation handle
+ * @param bytes Receives the memory used by the baked values (may be NULL)
+ * @return LOTTIE_OK on success, LOTTIE_ERR_NULL if handle is NULL,
+ *         LOTTIE_ERR_PARSE if the file can't be loaded again
+ * @note Scalars, points, colors and transform matrices become table
+ *       lookups; path and gradient keyframes are still interpolated.
+ *       A handle loaded from a file first gets its own copy of the
+ *       animation data, so other handles of the same cached file keep
+ *       evaluating keyframes. The tables are freed with the handle.
+ */
+int lottie_animation_bake_timeline(
+    LottieAnimationHandle handle,
+    size_t* bytes
+);
+
 /* ========== Serialization Functions ========== */
 
 /**
@@ -171,6 +350,79 @@ void lottie_animation_destroy(LottieAnimationHandle handle);
  */
 void lottie_configure_cache_size(size_t cacheSize);
 
+/**
+ * Configure the decoded image cache (library level)
+ * @param bytes Budget of decoded pixels shared by all animations,
+ *              0 = disable cache. Default is 64MB
+ * @note Image assets are decoded the first time they are drawn
+ */
+void lottie_configure_image_cache(size_t bytes);
+
+/**
+ * Drop all decoded images, e.g. on memory pressure
+ * @note Images drawn by a live animation are freed when it is destroyed,
+ *       the others are decoded again on next use
+ */
+void lottie_purge_image_cache(void);
+
+/**
+ * Configure the offscreen surface pool (library level)
+ * @param bytes Budget of free surfaces kept for reuse by the next frames
+ *              and by other animations, 0 = no reuse. Default is 32MB
+ */
+void lottie_configure_surface_cache(size_t bytes);
+
+/**
+ * Drop all free surfaces of the pool, e.g. on memory pressure
+ */
+void lottie_purge_surface_cache(void);
+
+/**
+ * Get the surface pool counters
+ * @param stats Output counters
+ * @return LOTTIE_OK on success, LOTTIE_ERR_NULL if stats is NULL
+ */
+int lottie_get_surface_cache_stats(LottieSurfaceCacheStats* stats);
+
+/**
+ * Select the rasterizer backend (library level)
+ * @param backend LOTTIE_RASTER_GRAY or LOTTIE_RASTER_ACCUM
+ * @return LOTTIE_OK on success, LOTTIE_ERR_INVALID for unknown backend
+ * @note The accumulation raster is faster for large filled shapes,
+ *       default is LOTTIE_RASTER_GRAY unless built with LOTTIE_ACCUM_RASTER
+ */
+int lottie_configure_rasterizer(int backend);
+
+/**
+ * Get the rasterizer backend in use
+ * @return LOTTIE_RASTER_GRAY or LOTTIE_RASTER_ACCUM
+ */
+int lottie_get_rasterizer(void);
+
+/**
+ * Select how keyframe easing curves are evaluated (library level)
+ * @param mode LOTTIE_EASING_EXACT or LOTTIE_EASING_TABLE
+ * @return LOTTIE_OK on success, LOTTIE_ERR_INVALID for unknown mode
+ * @note Tables are built at load time, only animations loaded after
+ *       the call are affected. Default is LOTTIE_EASING_EXACT
+ */
+int lottie_configure_easing(int mode);
+
+/**
+ * Get the easing evaluation mode used for animations loaded next
+ * @return LOTTIE_EASING_EXACT or LOTTIE_EASING_TABLE
+ */
+int lottie_get_easing(void);
+
+/**
+ * Select when image assets are decoded (library level)
+ * @param mode LOTTIE_IMAGE_DECODE_LAZY or LOTTIE_IMAGE_DECODE_PARALLEL
+ * @return LOTTIE_OK on success, LOTTIE_ERR_INVALID for unknown mode
+ * @note Parallel decoding stores the images in the image cache, see
+ *       lottie_configure_image_cache(). Default is LOTTIE_IMAGE_DECODE_LAZY
+ */
+int lottie_configure_image_decode(int mode);
+
 /* ========== Pixel Format Conversion ========== */
 
 /**
@@ -23,7 +23,11 @@
 #include "lottieitem.h"
 #include "lottiemodel.h"
 #include "rlottie.h"
+#include "vimageloader.h"
+#include "vinterpolator.h"
+#include "vraster.h"
 
+#include <cmath>
 #include <fstream>
 
 using namespace rlottie;
@@ -34,6 +38,66 @@ RLOTTIE_API void rlottie::configureModelCacheSize(size_t cacheSize)
     internal::model::configureModelCacheSize(cacheSize);
 }
 
+RLOTTIE_API void rlottie::configureImageCacheSize(size_t bytes)
+{
+    VImageCache::instance().setBudget(bytes);
+}
+
+RLOTTIE_API void rlottie::purgeImageCache()
+{
+    VImageCache::instance().purge();
+}
+
+RLOTTIE_API void rlottie::configureSurfaceCacheSize(size_t bytes)
+{
+    renderer::SurfacePool::instance().setBudget(bytes);
+}
+
+RLOTTIE_API void rlottie::purgeSurfaceCache()
+{
+    renderer::SurfacePool::instance().purge();
+}
+
+RLOTTIE_API rlottie::SurfaceCacheStats rlottie::surfaceCacheStats()
+{
+    return renderer::SurfacePool::instance().stats();
+}
+
+RLOTTIE_API void rlottie::configureRasterBackend(RasterBackend backend)
+{
+    VRasterizer::setBackend(backend == RasterBackend::Accumulation
+                                ? VRasterizer::Backend::Accumulation
+                                : VRasterizer::Backend::Gray);
+}
+
+RLOTTIE_API rlottie::RasterBackend rlottie::rasterBackend()
+{
+    return VRasterizer::backend() == VRasterizer::Backend::Accumulation
+               ? RasterBackend::Accumulation
+               : RasterBackend::Gray;
+}
+
+RLOTTIE_API void rlottie::configureEasing(EasingMode mode)
+{
+    VInterpolator::setMode(mode == EasingMode::Table
+                               ? VInterpolator::Mode::Table
+                               : VInterpolator::Mode::Exact);
+}
+
+RLOTTIE_API rlottie::EasingMode rlottie::easingMode()
+{
+    return VInterpolator::mode() == VInterpolator::Mode::Table
+               ? EasingMode::Table
+               : EasingMode::Exact;
+}
+
+RLOTTIE_API void rlottie::configureImageDecode(ImageDecode mode)
+{
+    model::Asset::setImageDecode(mode == ImageDecode::Parallel
+                                     ? model::Asset::ImageDecode::Parallel
+                                     : model::Asset::ImageDecode::Lazy);
+}
+
 struct RenderTask {
     RenderTask() { receiver = sender.get_future(); }
     std::promise<Surface> sender;
@@ -56,6 +120,8 @@ public:
     size_t  frameAtPos(double pos) const { return mModel->frameAtPos(pos); }
     Surface render(size_t frameNo, const Surface &surface,
                    bool keepAspectRatio);
+    Surface renderTime(double timeInSec, const Surface &surface,
+                       bool keepAspectRatio);
     std::future<Surface> renderAsync(size_t frameNo, Surface &&surface,
                                      bool keepAspectRatio);
     const LOTLayerNode * renderTree(size_t frameNo, const VSize &size);
@@ -70,8 +136,24 @@ public:
     const MarkerList &markers() const { return mModel->markers(); }
     void              setValue(const std::string &keypath, LOTVariant &&value);
     void              removeFilter(const std::string &keypath, Property prop);
+    void              setRenderQuality(RenderQuality quality)
+    {
+        mRenderer->setRenderQuality(quality);
+    }
+    void              setImageFilter(ImageFilter filter)
+    {
+        mRenderer->setImageFilter(filter);
+    }
+    size_t            bakeTimeline() { return mModel->bake(); }
+    AnimationStats    stats() const;
+    RenderStats       renderStats() const { return mRenderer->renderStats(); }
 
 private:
+    float   compFrame(size_t frameNo) const;
+    float   compFrameAtTime(double timeInSec) const;
+    Surface renderCompFrame(float compFrameNo, const Surface &surface,
+                            bool keepAspectRatio);
+
     mutable LayerInfoList                  mLayerList;
     model::Composition *                   mModel;
     SharedRenderTask                       mTask;
@@ -93,8 +175,7 @@ const LOTLayerNode *AnimationImpl::renderTree(size_t frameNo, const VSize &size)
     return mRenderer->renderTree();
 }
 
-bool AnimationImpl::update(size_t frameNo, const VSize &size,
-                           bool keepAspectRatio)
+float AnimationImpl::compFrame(size_t frameNo) const
 {
     frameNo += mModel->startFrame();
 
@@ -102,11 +183,49 @@ bool AnimationImpl::update(size_t frameNo, const VSize &size,
 
     if (frameNo < mModel->startFrame()) frameNo = mModel->startFrame();
 
-    return mRenderer->update(int(frameNo), size, keepAspectRatio);
+    return float(frameNo);
+}
+
+/*
+ * time is mapped on the composition frame line without rounding so the
+ * keyframes are interpolated in between two frames. Values within a
+ * 1/10000 of a frame snap to it to give the same result as compFrame().
+ */
+float AnimationImpl::compFrameAtTime(double timeInSec) const
+{
+    double frameNo = mModel->startFrame() + timeInSec * mModel->frameRate();
+
+    if (frameNo > mModel->endFrame()) frameNo = mModel->endFrame();
+
+    if (frameNo < mModel->startFrame()) frameNo = mModel->startFrame();
+
+    double wholeFrame = std::round(frameNo);
+    if (std::abs(frameNo - wholeFrame) < 1e-4) frameNo = wholeFrame;
+
+    return float(frameNo);
+}
+
+bool AnimationImpl::update(size_t frameNo, const VSize &size,
+                           bool keepAspectRatio)
+{
+    return mRenderer->update(compFrame(frameNo), size, keepAspectRatio);
 }
 
 Surface AnimationImpl::render(size_t frameNo, const Surface &surface,
                               bool keepAspectRatio)
+{
+    return renderCompFrame(compFrame(frameNo), surface, keepAspectRatio);
+}
+
+Surface AnimationImpl::renderTime(double timeInSec, const Surface &surface,
+                                  bool keepAspectRatio)
+{
+    return renderCompFrame(compFrameAtTime(timeInSec), surface,
+                           keepAspectRatio);
+}
+
+Surface AnimationImpl::renderCompFrame(float compFrameNo, const Surface &surface,
+                                       bool keepAspectRatio)
 {
     bool renderInProgress = mRenderInProgress.load();
     if (renderInProgress) {
@@ -115,8 +234,8 @@ Surface AnimationImpl::render(size_t frameNo, const Surface &surface,
     }
 
     mRenderInProgress.store(true);
-    update(
-        frameNo,
+    mRenderer->update(
+        compFrameNo,
         VSize(int(surface.drawRegionWidth()), int(surface.drawRegionHeight())),
         keepAspectRatio);
     mRenderer->render(surface);
@@ -371,6 +490,69 @@ void Animation::renderSync(size_t frameNo, Surface surface,
     d->render(frameNo, surface, keepAspectRatio);
 }
 
+void Animation::renderSyncAtTime(double timeInSec, Surface surface,
+                                 bool keepAspectRatio)
+{
+    d->renderTime(timeInSec, surface, keepAspectRatio);
+}
+
+void Animation::setRenderQuality(RenderQuality quality)
+{
+    d->setRenderQuality(quality);
+}
+
+void Animation::setImageFilter(ImageFilter filter)
+{
+    d->setImageFilter(filter);
+}
+
+size_t Animation::bakeTimeline()
+{
+    return d->bakeTimeline();
+}
+
+AnimationStats AnimationImpl::stats() const
+{
+    const auto &   s = mModel->mStats;
+    AnimationStats result;
+
+    result.shapeLayerCount = s.shapeLayerCount;
+    result.precompLayerCount = s.precompLayerCount;
+    result.imageLayerCount = s.imageLayerCount;
+    result.solidLayerCount = s.solidLayerCount;
+    result.layerCount = s.shapeLayerCount + s.precompLayerCount +
+                        s.imageLayerCount + s.solidLayerCount +
+                        s.nullLayerCount;
+    result.staticLayerCount = s.staticLayerCount;
+    result.hiddenLayerCount = s.hiddenLayerCount;
+    result.matteLayerCount = s.matteLayerCount;
+    result.maskLayerCount = s.maskLayerCount;
+    result.offscreenLayerCount = s.offscreenLayerCount;
+    result.maxPathPoints = s.maxPathPoints;
+    result.pathCount = s.pathCount;
+    result.uniquePathCount = s.uniquePathCount;
+    result.sharedPathBytes = s.sharedPathBytes;
+    result.hasContent = s.activeInFrame <= s.activeOutFrame;
+    if (result.hasContent) {
+        // reported relative to the first frame, like every frame number
+        // of the public api
+        result.activeInFrame = size_t(s.activeInFrame - mModel->startFrame());
+        result.activeOutFrame = size_t(s.activeOutFrame - mModel->startFrame());
+    }
+    result.isStatic = mModel->isStatic();
+    return result;
+}
+
+AnimationStats Animation::stats() const
+{
+    return d->stats();
+}
+
+RenderStats Animation::renderStats() const
+{
+    return d->renderStats();
+}
+
 const LayerInfoList &Animation::layers() const
 {
     return d->layerInfoList();
@@ -436,6 +618,43 @@ void Animation::setValue(Point_Type, Property prop, const std::string &keypath,
 Animation::~Animation() = default;
 Animation::Animation() : d(std::make_unique<AnimationImpl>()) {}
 
+class AnimationLoaderImpl {
+public:
+    explicit AnimationLoaderImpl(std::string resourcePath)
+        : mParser(std::move(resourcePath))
+    {
+    }
+    model::StreamParser mParser;
+    bool                mFinished{false};
+};
+
+AnimationLoader::AnimationLoader(std::string resourcePath)
+    : d(std::make_unique<AnimationLoaderImpl>(std::move(resourcePath)))
+{
+}
+
+AnimationLoader::~AnimationLoader() = default;
+
+void AnimationLoader::feed(const char *data, size_t size)
+{
+    if (d->mFinished) return;
+    d->mParser.feed(data, size);
+}
+
+std::unique_ptr<Animation> AnimationLoader::finish()
+{
+    if (d->mFinished) return nullptr;
+    d->mFinished = true;
+
+    auto composition = d->mParser.finish();
+    if (composition) {
+        auto animation = std::unique_ptr<Animation>(new Animation);
+        animation->d->init(std::move(composition));
+        return animation;
+    }
+    return nullptr;
+}
+
 Surface::Surface(uint32_t *buffer, size_t width, size_t height,
                  size_t bytesPerLine)
     : mBuffer(buffer),
@@ -108,6 +108,99 @@ static renderer::Layer *createLayerItem(model::Layer *layerData,
     }
 }
 
+/*
+ * Size classes are powers of two and the midpoints between them, a pooled
+ * buffer is at most a third larger than the surface it holds.
+ */
+size_t renderer::SurfacePool::sizeClass(size_t bytes)
+{
+    size_t size = 4096;
+    while (size < bytes) {
+        if (size + size / 2 >= bytes) return size + size / 2;
+        size *= 2;
+    }
+    return size;
+}
+
+VBitmap renderer::SurfacePool::acquire(size_t width, size_t height,
+                                       VBitmap::Format format)
+{
+    size_t depth = (format == VBitmap::Format::Alpha8) ? 1 : 4;
+    size_t size = sizeClass(((width * depth + 3) & ~size_t(3)) * height);
+
+    VBitmap surface;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto                        it = mFree.find(size);
+        if (it != mFree.end() && !it->second.empty()) {
+            surface = std::move(it->second.back());
+            it->second.pop_back();
+            mFreeBytes -= size;
+            mStats.reuses++;
+        } else {
+            mLiveBytes += size;
+            mStats.allocations++;
+            mStats.peakBytes = std::max(mStats.peakBytes, mLiveBytes);
+        }
+        mStats.retainedBytes = mFreeBytes;
+    }
+
+    if (!surface.valid()) surface.reserve(size);
+    surface.reset(width, height, format);
+    return surface;
+}
+
+void renderer::SurfacePool::release(VBitmap &&surface)
+{
+    // destroyed after the lock if it is not kept.
+    VBitmap local = std::move(surface);
+    size_t  size = local.capacity();
+    if (!size) return;
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mFreeBytes + size > mBudget) {
+        mLiveBytes -= size;
+        return;
+    }
+    mFree[size].push_back(std::move(local));
+    mFreeBytes += size;
+    mStats.retainedBytes = mFreeBytes;
+}
+
+void renderer::SurfacePool::setBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudget = bytes;
+    trim(bytes);
+}
+
+void renderer::SurfacePool::purge()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    trim(0);
+}
+
+rlottie::SurfaceCacheStats renderer::SurfacePool::stats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+// largest surfaces go first, called with the lock held.
+void renderer::SurfacePool::trim(size_t budget)
+{
+    for (auto it = mFree.rbegin(); it != mFree.rend() && mFreeBytes > budget;
+         ++it) {
+        auto &list = it->second;
+        while (!list.empty() && mFreeBytes > budget) {
+            list.pop_back();
+            mFreeBytes -= it->first;
+            mLiveBytes -= it->first;
+        }
+    }
+    mStats.retainedBytes = mFreeBytes;
+}
+
 renderer::Composition::Composition(std::shared_ptr<model::Composition> model)
     : mCurFrameNo(-1)
 {
@@ -125,17 +218,46 @@ void renderer::Composition::setValue(const std::string &keypath,
     mRootLayer->resolveKeyPath(key, 0, value);
 }
 
-bool renderer::Composition::update(int frameNo, const VSize &size,
+void renderer::Composition::setImageFilter(rlottie::ImageFilter filter)
+{
+    mRootLayer->setImageFilter(filter);
+}
+
+/*
+ * Curve flattening tolerance in device pixels. Paths are flattened after
+ * the transform to the surface, so the tolerance holds at any output
+ * scale and Auto keeps the default half pixel like Normal.
+ */
+float renderer::Composition::flatness() const
+{
+    switch (mQuality) {
+    case rlottie::RenderQuality::High:
+        return VRasterizer::DefaultFlatness / 2;
+    case rlottie::RenderQuality::Fast:
+        return VRasterizer::DefaultFlatness * 2;
+    default:
+        return VRasterizer::DefaultFlatness;
+    }
+}
+
+bool renderer::Composition::update(float frameNo, const VSize &size,
                                    bool keepAspectRatio)
 {
+    float flatness = this->flatness();
+
     // check if cached frame is same as requested frame.
     if (!mHasDynamicValue && (mViewSize == size) && (mCurFrameNo == frameNo) &&
-        (mKeepAspectRatio == keepAspectRatio))
+        (mKeepAspectRatio == keepAspectRatio) && vCompare(mFlatness, flatness))
         return false;
 
+    // rasterized content is only regenerated when dirty, force it if the
+    // tolerance changed without a matrix change.
+    if (!vCompare(mFlatness, flatness)) mRootLayer->invalidate();
+
     mViewSize = size;
     mCurFrameNo = frameNo;
     mKeepAspectRatio = keepAspectRatio;
+    mFlatness = flatness;
 
     /*
      * if viewbox dosen't scale exactly to the viewport
@@ -170,7 +292,15 @@ bool renderer::Composition::render(const rlottie::Surface &surface)
      */
     VRect clip(0, 0, int(surface.drawRegionWidth()),
                int(surface.drawRegionHeight()));
-    mRootLayer->preprocess(clip);
+    mRootLayer->preprocess(clip, mFlatness);
+    if (mRootLayer->precompLayer()) {
+        auto root = static_cast<CompLayer *>(mRootLayer);
+#ifdef LOTTIE_THREAD_SUPPORT
+        root->cullOccluded(clip, mFlatness, false);
+#endif
+        mRenderStats.drawnLayerCount = root->drawnLayers();
+        mRenderStats.culledLayerCount = root->culledLayers();
+    }
 
     VPainter painter(&mSurface);
     // set sub surface area for drawing.
@@ -182,7 +312,7 @@ bool renderer::Composition::render(const rlottie::Surface &surface)
     return true;
 }
 
-void renderer::Mask::update(int frameNo, const VMatrix &parentMatrix,
+void renderer::Mask::update(float frameNo, const VMatrix &parentMatrix,
                             float /*parentAlpha*/, const DirtyFlag &flag)
 {
     bool dirtyPath = false;
@@ -219,10 +349,17 @@ VRle renderer::Mask::rle()
     }
 }
 
-void renderer::Mask::preprocess(const VRect &clip)
+void renderer::Mask::preprocess(const VRect &clip, float flatness)
 {
     if (mRasterRequest)
-        mRasterizer.rasterize(mFinalPath, FillRule::Winding, clip);
+        mRasterizer.rasterize(mFinalPath, FillRule::Winding, clip, flatness);
+}
+
+VRect renderer::Layer::drawBounds()
+{
+    VRect bounds;
+    for (auto &i : renderList()) bounds = bounds.united(i->rle().boundingRect());
+    return bounds;
 }
 
 void renderer::Layer::render(VPainter *painter, const VRle &inheritMask,
@@ -269,10 +406,67 @@ void renderer::Layer::render(VPainter *painter, const VRle &inheritMask,
     }
 }
 
-void renderer::LayerMask::preprocess(const VRect &clip)
+bool renderer::Layer::coverage(const VRle &inheritMask, const VRect &clip,
+                               VRle &result)
+{
+    if (mLayerData->mLayerType != model::Layer::Type::Shape &&
+        mLayerData->mLayerType != model::Layer::Type::Solid)
+        return false;
+
+    result = VRle();
+
+    auto renderlist = renderList();
+    if (renderlist.empty()) return true;
+
+    VRle mask;
+    if (mLayerMask) {
+        mask = mLayerMask->maskRle(clip);
+        if (!inheritMask.empty()) mask = mask & inheritMask;
+        if (mask.empty()) return true;
+    } else {
+        mask = inheritMask;
+    }
+
+    // same result as painting the drawables in order, the alpha channel
+    // composes with src-over.
+    for (auto &i : renderlist) {
+        if (i->mBrush.type() != VBrush::Type::Solid) return false;
+        VRle rle = i->rle();
+        if (!mask.empty()) rle = rle & mask;
+        if (i->mBrush.mColor.alpha() != 255) rle *= i->mBrush.mColor.alpha();
+        result = result + rle;
+    }
+
+    // a translucent shape layer is blended from its offscreen buffer.
+    if (mLayerData->mLayerType == model::Layer::Type::Shape &&
+        !vCompare(combinedAlpha(), 1.0)) {
+        result *= uint8_t(combinedAlpha() * 255.0f);
+    }
+
+    return true;
+}
+
+bool renderer::Layer::occludes(const VRect &area)
+{
+    if (mLayerMask || hasMatte() || !vCompare(combinedAlpha(), 1.0))
+        return false;
+
+    if (mLayerData->mLayerType != model::Layer::Type::Shape &&
+        mLayerData->mLayerType != model::Layer::Type::Solid &&
+        mLayerData->mLayerType != model::Layer::Type::Image)
+        return false;
+
+    // drawables above the covering one can only add to it.
+    for (auto &i : renderList()) {
+        if (i->mBrush.opaque() && i->rle().covers(area)) return true;
+    }
+    return false;
+}
+
+void renderer::LayerMask::preprocess(const VRect &clip, float flatness)
 {
     for (auto &i : mMasks) {
-        i.preprocess(clip);
+        i.preprocess(clip, flatness);
     }
 }
 
@@ -288,7 +482,7 @@ renderer::LayerMask::LayerMask(model::Layer *layerData)
     }
 }
 
-void renderer::LayerMask::update(int frameNo, const VMatrix &parentMatrix,
+void renderer::LayerMask::update(float frameNo, const VMatrix &parentMatrix,
                                  float parentAlpha, const DirtyFlag &flag)
 {
     if (flag.testFlag(DirtyFlagBit::None) && isStatic()) return;
@@ -399,7 +593,7 @@ bool renderer::CompLayer::resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
     return false;
 }
 
-void renderer::Layer::update(int frameNumber, const VMatrix &parentMatrix,
+void renderer::Layer::update(float frameNumber, const VMatrix &parentMatrix,
                              float parentAlpha)
 {
     mFrameNo = frameNumber;
@@ -445,7 +639,7 @@ void renderer::Layer::update(int frameNumber, const VMatrix &parentMatrix,
     mDirtyFlag = DirtyFlagBit::None;
 }
 
-VMatrix renderer::Layer::matrix(int frameNo) const
+VMatrix renderer::Layer::matrix(float frameNo) const
 {
     return mParentLayer
                ? (mLayerData->matrix(frameNo) * mParentLayer->matrix(frameNo))
@@ -458,15 +652,15 @@ bool renderer::Layer::visible() const
             frameNo() <= mLayerData->outFrame());
 }
 
-void renderer::Layer::preprocess(const VRect &clip)
+void renderer::Layer::preprocess(const VRect &clip, float flatness)
 {
     // layer dosen't contribute to the frame
     if (skipRendering()) return;
 
     // preprocess layer masks
-    if (mLayerMask) mLayerMask->preprocess(clip);
+    if (mLayerMask) mLayerMask->preprocess(clip, flatness);
 
-    preprocessStage(clip);
+    preprocessStage(clip, flatness);
 }
 
 renderer::CompLayer::CompLayer(model::Layer *layerModel, VArenaAlloc *allocator)
@@ -482,7 +676,11 @@ renderer::CompLayer::CompLayer(model::Layer *layerModel, VArenaAlloc *allocator)
         if ((*it)->type() != model::Object::Type::Layer) continue;
         auto model = static_cast<model::Layer *>(*it);
         auto item = createLayerItem(model, allocator);
-        if (item) mLayers.push_back(item);
+        if (item) {
+            mLayers.push_back(item);
+            mInFrames.push_back(model->inFrame());
+            mOutFrames.push_back(model->outFrame());
+        }
     }
 
     // 2. update parent layer
@@ -496,6 +694,10 @@ renderer::CompLayer::CompLayer(model::Layer *layerModel, VArenaAlloc *allocator)
         }
     }
 
+    // 3. index the frame ranges
+    std::sort(mInFrames.begin(), mInFrames.end());
+    std::sort(mOutFrames.begin(), mOutFrames.end());
+
     // 4. check if its a nested composition
     if (!layerModel->layerSize().empty()) {
         mClipper = std::make_unique<renderer::Clipper>(layerModel->layerSize());
@@ -513,13 +715,16 @@ void renderer::CompLayer::render(VPainter *painter, const VRle &inheritMask,
         renderHelper(painter, inheritMask, matteRle, cache);
     } else {
         if (complexContent()) {
-            VSize    size = painter->clipBoundingRect().size();
+            // only the drawn area is blended back, see renderMatteLayer().
+            VRect bounds = drawBounds() & painter->clipBoundingRect();
+            if (bounds.empty()) return;
             VPainter srcPainter;
-            VBitmap srcBitmap = cache.make_surface(size.width(), size.height());
-            srcPainter.begin(&srcBitmap);
+            VBitmap  srcBitmap =
+                cache.make_surface(bounds.width(), bounds.height());
+            srcPainter.begin(&srcBitmap, VPoint(bounds.x(), bounds.y()));
             renderHelper(&srcPainter, inheritMask, matteRle, cache);
             srcPainter.end();
-            painter->drawBitmap(VPoint(), srcBitmap,
+            painter->drawBitmap(bounds, srcBitmap,
                                 uint8_t(combinedAlpha() * 255.0f));
             cache.release_surface(srcBitmap);
         } else {
@@ -528,6 +733,15 @@ void renderer::CompLayer::render(VPainter *painter, const VRle &inheritMask,
     }
 }
 
+VRect renderer::CompLayer::drawBounds()
+{
+    VRect bounds;
+    for (size_t n = mDrawnFrom; n < mActiveLayers.size(); n++)
+        bounds = bounds.united(mLayers[mActiveLayers[n]]->drawBounds());
+    if (mClipper) bounds = bounds & mClipper->rle({}).boundingRect();
+    return bounds;
+}
+
 void renderer::CompLayer::renderHelper(VPainter *    painter,
                                        const VRle &  inheritMask,
                                        const VRle &  matteRle,
@@ -548,21 +762,17 @@ void renderer::CompLayer::renderHelper(VPainter *    painter,
         if (mask.empty()) return;
     }
 
-    renderer::Layer *matte = nullptr;
-    for (const auto &layer : mLayers) {
-        if (layer->hasMatte()) {
-            matte = layer;
+    for (size_t n = mDrawnFrom; n < mActiveLayers.size(); n++) {
+        auto i = mActiveLayers[n];
+        auto layer = mLayers[i];
+        if (layer->hasMatte()) continue;
+
+        auto matte = matteLayer(i);
+        if (matte) {
+            if (matte->visible())
+                renderMatteLayer(painter, mask, matteRle, matte, layer, cache);
         } else {
-            if (layer->visible()) {
-                if (matte) {
-                    if (matte->visible())
-                        renderMatteLayer(painter, mask, matteRle, matte, layer,
-                                         cache);
-                } else {
-                    layer->render(painter, mask, matteRle, cache);
-                }
-            }
-            matte = nullptr;
+            layer->render(painter, mask, matteRle, cache);
         }
     }
 }
@@ -573,58 +783,81 @@ void renderer::CompLayer::renderMatteLayer(VPainter *painter, const VRle &mask,
                                            renderer::Layer *src,
                                            SurfaceCache &   cache)
 {
-    VSize size = painter->clipBoundingRect().size();
+    // the result is limited to the layer, and for a regular matte also to
+    // the matte source. Both buffers only need to cover that area.
+    // Pixels outside of it are left as they are. A canvas sized buffer
+    // used to blend its transparent pixels too, and BYTE_MUL(dest, 255)
+    // took 1 off every channel there.
+    VRect bounds = layer->drawBounds() & painter->clipBoundingRect();
+    if (layer->matteType() == model::MatteType::Alpha ||
+        layer->matteType() == model::MatteType::Luma) {
+        bounds = bounds & src->drawBounds();
+    }
+    if (bounds.empty()) return;
+
     // Decide if we can use fast matte.
+    // a solid color alpha matte over a layer that draws a single drawable
+    // is applied as an rle clip, no offscreen buffer needed. The clip is
+    // applied per drawable, with more of them the overlap would get the
+    // matte twice, so they go through the layer buffer.
+    if (matteRle.empty() && !layer->precompLayer() &&
+        layer->renderList().size() == 1 &&
+        (layer->matteType() == model::MatteType::Alpha ||
+         layer->matteType() == model::MatteType::AlphaInv)) {
+        VRle coverage;
+        if (src->coverage(mask, painter->clipBoundingRect(), coverage)) {
+            // an empty rle means no matte to the layer.
+            if (coverage.empty() &&
+                layer->matteType() == model::MatteType::Alpha)
+                return;
+            layer->render(painter, mask, coverage, cache);
+            return;
+        }
+    }
+
+    VPoint origin(bounds.x(), bounds.y());
+
     // 1. draw src layer to matte buffer
     VPainter srcPainter;
-    VBitmap  srcBitmap = cache.make_surface(size.width(), size.height());
-    srcPainter.begin(&srcBitmap);
+    VBitmap  srcBitmap = cache.make_surface(bounds.width(), bounds.height());
+    srcPainter.begin(&srcBitmap, origin);
     src->render(&srcPainter, mask, matteRle, cache);
     srcPainter.end();
 
     // 2. draw layer to layer buffer
     VPainter layerPainter;
-    VBitmap  layerBitmap = cache.make_surface(size.width(), size.height());
-    layerPainter.begin(&layerBitmap);
+    VBitmap  layerBitmap = cache.make_surface(bounds.width(), bounds.height());
+    layerPainter.begin(&layerBitmap, origin);
     layer->render(&layerPainter, mask, matteRle, cache);
 
-    // 2.1update composition mode
+    // 2.1update composition mode, luma mattes convert the src buffer
+    // while blending.
     switch (layer->matteType()) {
-    case model::MatteType::Alpha:
-    case model::MatteType::Luma: {
+    case model::MatteType::Alpha: {
         layerPainter.setBlendMode(BlendMode::DestIn);
         break;
     }
-    case model::MatteType::AlphaInv:
-    case model::MatteType::LumaInv: {
+    case model::MatteType::AlphaInv: {
         layerPainter.setBlendMode(BlendMode::DestOut);
         break;
     }
-    default:
+    case model::MatteType::Luma: {
+        layerPainter.setBlendMode(BlendMode::LumaIn);
         break;
     }
-
-    // 2.2 update srcBuffer if the matte is luma type
-    if (layer->matteType() == model::MatteType::Luma ||
-        layer->matteType() == model::MatteType::LumaInv) {
-        srcBitmap.updateLuma();
+    case model::MatteType::LumaInv: {
+        layerPainter.setBlendMode(BlendMode::LumaOut);
+        break;
     }
-
-    auto clip = layerPainter.clipBoundingRect();
-
-    // if the layer has only one renderer then use it as the clip rect
-    // when blending 2 buffer and copy back to final buffer to avoid
-    // unnecessary pixel processing.
-    if (layer->renderList().size() == 1)
-    {
-        clip = layer->renderList()[0]->rle().boundingRect();
+    default:
+        break;
     }
 
-    // 2.3 draw src buffer as mask
-    layerPainter.drawBitmap(clip, srcBitmap, clip);
+    // 2.2 draw src buffer as mask
+    layerPainter.drawBitmap(bounds, srcBitmap);
     layerPainter.end();
     // 3. draw the result buffer into painter
-    painter->drawBitmap(clip, layerBitmap, clip);
+    painter->drawBitmap(bounds, layerBitmap);
 
     cache.release_surface(srcBitmap);
     cache.release_surface(layerBitmap);
@@ -638,9 +871,10 @@ void renderer::Clipper::update(const VMatrix &matrix)
     mRasterRequest = true;
 }
 
-void renderer::Clipper::preprocess(const VRect &clip)
+void renderer::Clipper::preprocess(const VRect &clip, float flatness)
 {
-    if (mRasterRequest) mRasterizer.rasterize(mPath, FillRule::Winding, clip);
+    if (mRasterRequest)
+        mRasterizer.rasterize(mPath, FillRule::Winding, clip, flatness);
 
     mRasterRequest = false;
 }
@@ -654,42 +888,140 @@ VRle renderer::Clipper::rle(const VRle &mask)
     return mMaskedRle;
 }
 
+void renderer::CompLayer::invalidate()
+{
+    renderer::Layer::invalidate();
+    for (const auto &layer : mLayers) layer->invalidate();
+}
+
+void renderer::CompLayer::setImageFilter(rlottie::ImageFilter filter)
+{
+    for (const auto &layer : mLayers) layer->setImageFilter(filter);
+}
+
 void renderer::CompLayer::updateContent()
 {
     if (mClipper && flag().testFlag(DirtyFlagBit::Matrix)) {
         mClipper->update(combinedMatrix());
     }
-    int   mappedFrame = mLayerData->timeRemap(frameNo());
+    float mappedFrame = mLayerData->timeRemap(frameNo());
     float alpha = combinedAlpha();
     if (complexContent()) alpha = 1;
-    for (const auto &layer : mLayers) {
-        layer->update(mappedFrame, combinedMatrix(), alpha);
+
+    auto key = std::make_pair(
+        size_t(std::upper_bound(mInFrames.begin(), mInFrames.end(),
+                                mappedFrame) -
+               mInFrames.begin()),
+        size_t(std::lower_bound(mOutFrames.begin(), mOutFrames.end(),
+                                mappedFrame) -
+               mOutFrames.begin()));
+
+    if (key == mActiveKey) {
+        for (auto i : mActiveLayers) {
+            mLayers[i]->update(mappedFrame, combinedMatrix(), alpha);
+        }
+        return;
+    }
+
+    // some layer started or ended, update all of them so the ended ones
+    // know they are hidden.
+    mActiveKey = key;
+    mActiveLayers.clear();
+    for (size_t i = 0; i < mLayers.size(); i++) {
+        mLayers[i]->update(mappedFrame, combinedMatrix(), alpha);
+        if (mLayers[i]->visible()) mActiveLayers.push_back(i);
     }
 }
 
-void renderer::CompLayer::preprocessStage(const VRect &clip)
+void renderer::CompLayer::preprocessStage(const VRect &clip, float flatness)
 {
     // if layer has clipper
-    if (mClipper) mClipper->preprocess(clip);
+    if (mClipper) mClipper->preprocess(clip, flatness);
+
+#ifdef LOTTIE_THREAD_SUPPORT
+    // asking for an rle waits for its raster task, so only schedule the
+    // layers here. Composition::render() culls once the whole tree is
+    // scheduled, the hidden layers are rasterized but not blended.
+    for (auto i : mActiveLayers) {
+        auto layer = mLayers[i];
+        if (layer->hasMatte()) continue;
+
+        auto matte = matteLayer(i);
+        if (matte) {
+            if (matte->visible()) {
+                layer->preprocess(clip, flatness);
+                matte->preprocess(clip, flatness);
+            }
+        } else {
+            layer->preprocess(clip, flatness);
+        }
+    }
+#else
+    // the rle is ready once a layer is preprocessed, cull on the way so
+    // the hidden layers are not even rasterized.
+    cullOccluded(clip, flatness, true);
+#endif
+}
 
-    renderer::Layer *matte = nullptr;
-    for (const auto &layer : mLayers) {
-        if (layer->hasMatte()) {
-            matte = layer;
+void renderer::CompLayer::cullOccluded(const VRect &clip, float flatness,
+                                       bool preprocess)
+{
+    // layer dosen't contribute to the frame, nothing was preprocessed.
+    if (skipRendering()) return;
+
+    // a layer hides the ones below it only if the mask applied to all of
+    // them is either full or none, a soft edge lets the lower ones through.
+    VRect area = clip;
+    bool  cull = mCullOccluded && !mLayerMask;
+    if (cull && mClipper) {
+        VRle rle = mClipper->rle({});
+        area = area & rle.boundingRect();
+        cull = rle.covers(rle.boundingRect());
+    }
+
+    mDrawnFrom = 0;
+    mDrawnLayers = 0;
+    mCulledLayers = 0;
+    for (size_t n = mActiveLayers.size(); n--;) {
+        auto i = mActiveLayers[n];
+        auto layer = mLayers[i];
+        if (layer->hasMatte()) continue;
+
+        auto matte = matteLayer(i);
+        if (matte) {
+            if (matte->visible()) {
+                cullLayer(layer, cull, clip, flatness, preprocess);
+                cullLayer(matte, cull, clip, flatness, preprocess);
+            }
         } else {
-            if (layer->visible()) {
-                if (matte) {
-                    if (matte->visible()) {
-                        layer->preprocess(clip);
-                        matte->preprocess(clip);
-                    }
-                } else {
-                    layer->preprocess(clip);
-                }
+            cullLayer(layer, cull, clip, flatness, preprocess);
+            if (cull && !area.empty() && layer->occludes(area)) {
+                mDrawnFrom = n;
+                break;
             }
-            matte = nullptr;
         }
     }
+    mDrawnLayers += mActiveLayers.size() - mDrawnFrom;
+    mCulledLayers += mDrawnFrom;
+}
+
+void renderer::CompLayer::cullLayer(Layer *layer, bool cull, const VRect &clip,
+                                    float flatness, bool preprocess)
+{
+    if (!layer->precompLayer()) {
+        if (preprocess) layer->preprocess(clip, flatness);
+        return;
+    }
+
+    auto comp = static_cast<CompLayer *>(layer);
+    comp->mCullOccluded = cull;
+    if (preprocess)
+        comp->preprocess(clip, flatness);
+    else
+        comp->cullOccluded(clip, flatness, false);
+    if (comp->skipRendering()) return;
+    mDrawnLayers += comp->mDrawnLayers;
+    mCulledLayers += comp->mCulledLayers;
 }
 
 renderer::SolidLayer::SolidLayer(model::Layer *layerData)
@@ -716,9 +1048,10 @@ void renderer::SolidLayer::updateContent()
     }
 }
 
-void renderer::SolidLayer::preprocessStage(const VRect &clip)
+void renderer::SolidLayer::preprocessStage(const VRect &clip,
+                                           float        flatness)
 {
-    mRenderNode.preprocess(clip);
+    mRenderNode.preprocess(clip, flatness);
 }
 
 renderer::DrawableList renderer::SolidLayer::renderList()
@@ -735,7 +1068,6 @@ renderer::ImageLayer::ImageLayer(model::Layer *layerData)
 
     if (!mLayerData->asset()) return;
 
-    mTexture.mBitmap = mLayerData->asset()->bitmap();
     VBrush brush(&mTexture);
     mRenderNode.setBrush(brush);
 }
@@ -744,6 +1076,10 @@ void renderer::ImageLayer::updateContent()
 {
     if (!mLayerData->asset()) return;
 
+    // decode the image the first time the layer is visible.
+    if (!mTexture.mBitmap.valid())
+        mTexture.mBitmap = mLayerData->asset()->bitmap();
+
     if (flag() & DirtyFlagBit::Matrix) {
         mPath.reset();
         mPath.addRect(VRectF(0, 0, mLayerData->asset()->mWidth,
@@ -759,9 +1095,10 @@ void renderer::ImageLayer::updateContent()
     }
 }
 
-void renderer::ImageLayer::preprocessStage(const VRect &clip)
+void renderer::ImageLayer::preprocessStage(const VRect &clip,
+                                           float        flatness)
 {
-    mRenderNode.preprocess(clip);
+    mRenderNode.preprocess(clip, flatness);
 }
 
 renderer::DrawableList renderer::ImageLayer::renderList()
@@ -856,12 +1193,14 @@ void renderer::ShapeLayer::updateContent()
     }
 }
 
-void renderer::ShapeLayer::preprocessStage(const VRect &clip)
+void renderer::ShapeLayer::preprocessStage(const VRect &clip,
+                                           float        flatness)
 {
     mDrawableList.clear();
     mRoot->renderList(mDrawableList);
 
-    for (auto &drawable : mDrawableList) drawable->preprocess(clip);
+    for (auto &drawable : mDrawableList)
+        drawable->preprocess(clip, flatness);
 }
 
 renderer::DrawableList renderer::ShapeLayer::renderList()
@@ -884,14 +1223,16 @@ void renderer::ShapeLayer::render(VPainter *painter, const VRle &inheritMask,
     if (vCompare(combinedAlpha(), 1.0)) {
         Layer::render(painter, inheritMask, matteRle, cache);
     } else {
-        //do offscreen rendering
-        VSize    size = painter->clipBoundingRect().size();
+        //do offscreen rendering, of the drawn area only, see
+        // renderMatteLayer().
+        VRect bounds = drawBounds() & painter->clipBoundingRect();
+        if (bounds.empty()) return;
         VPainter srcPainter;
-        VBitmap srcBitmap = cache.make_surface(size.width(), size.height());
-        srcPainter.begin(&srcBitmap);
+        VBitmap  srcBitmap = cache.make_surface(bounds.width(), bounds.height());
+        srcPainter.begin(&srcBitmap, VPoint(bounds.x(), bounds.y()));
         Layer::render(&srcPainter, inheritMask, matteRle, cache);
         srcPainter.end();
-        painter->drawBitmap(VPoint(), srcBitmap,
+        painter->drawBitmap(bounds, srcBitmap,
                             uint8_t(combinedAlpha() * 255.0f));
         cache.release_surface(srcBitmap);
     }
@@ -975,7 +1316,7 @@ void renderer::Group::addChildren(model::Group *data, VArenaAlloc *allocator)
     }
 }
 
-void renderer::Group::update(int frameNo, const VMatrix &parentMatrix,
+void renderer::Group::update(float frameNo, const VMatrix &parentMatrix,
                              float parentAlpha, const DirtyFlag &flag)
 {
     DirtyFlag newFlag = flag;
@@ -1059,6 +1400,27 @@ void renderer::Group::processPaintItems(std::vector<renderer::Shape *> &list)
     }
 }
 
+void renderer::Group::collectContent(std::vector<renderer::Shape *> &shapes,
+                                     std::vector<renderer::Paint *> &paints)
+{
+    for (const auto &content : mContents) {
+        switch (content->type()) {
+        case renderer::Object::Type::Shape:
+            shapes.push_back(static_cast<renderer::Shape *>(content));
+            break;
+        case renderer::Object::Type::Paint:
+            paints.push_back(static_cast<renderer::Paint *>(content));
+            break;
+        case renderer::Object::Type::Group:
+            static_cast<renderer::Group *>(content)->collectContent(shapes,
+                                                                    paints);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 void renderer::Group::processTrimItems(std::vector<renderer::Shape *> &list)
 {
     size_t curOpCount = list.size();
@@ -1102,7 +1464,7 @@ void renderer::Group::processTrimItems(std::vector<renderer::Shape *> &list)
  * carefull about the refcount so that we don't generate deep copy while
  * modifying the path objects.
  */
-void renderer::Shape::update(int              frameNo, const VMatrix &, float,
+void renderer::Shape::update(float            frameNo, const VMatrix &, float,
                              const DirtyFlag &flag)
 {
     mDirtyPath = false;
@@ -1113,7 +1475,10 @@ void renderer::Shape::update(int              frameNo, const VMatrix &, float,
         // from the last frame update.
         mTemp = VPath();
 
-        updatePath(mLocalPath, frameNo);
+        if (mSource)
+            mLocalPath = mSource->mLocalPath;
+        else
+            updatePath(mLocalPath, frameNo);
         mDirtyPath = true;
     }
     // 2. keep a reference path in temp in case there is some
@@ -1137,7 +1502,7 @@ renderer::Rect::Rect(model::Rect *data)
 {
 }
 
-void renderer::Rect::updatePath(VPath &path, int frameNo)
+void renderer::Rect::updatePath(VPath &path, float frameNo)
 {
     VPointF pos = mData->mPos.value(frameNo);
     VPointF size = mData->mSize.value(frameNo);
@@ -1154,7 +1519,7 @@ renderer::Ellipse::Ellipse(model::Ellipse *data)
 {
 }
 
-void renderer::Ellipse::updatePath(VPath &path, int frameNo)
+void renderer::Ellipse::updatePath(VPath &path, float frameNo)
 {
     VPointF pos = mData->mPos.value(frameNo);
     VPointF size = mData->mSize.value(frameNo);
@@ -1170,7 +1535,7 @@ renderer::Path::Path(model::Path *data)
 {
 }
 
-void renderer::Path::updatePath(VPath &path, int frameNo)
+void renderer::Path::updatePath(VPath &path, float frameNo)
 {
     mData->mShape.value(frameNo, path);
 }
@@ -1180,7 +1545,7 @@ renderer::Polystar::Polystar(model::Polystar *data)
 {
 }
 
-void renderer::Polystar::updatePath(VPath &path, int frameNo)
+void renderer::Polystar::updatePath(VPath &path, float frameNo)
 {
     VPointF pos = mData->mPos.value(frameNo);
     float   points = mData->mPointCount.value(frameNo);
@@ -1212,7 +1577,7 @@ void renderer::Polystar::updatePath(VPath &path, int frameNo)
  */
 renderer::Paint::Paint(bool staticContent) : mStaticContent(staticContent) {}
 
-void renderer::Paint::update(int frameNo, const VMatrix &parentMatrix,
+void renderer::Paint::update(float frameNo, const VMatrix &parentMatrix,
                              float parentAlpha, const DirtyFlag & /*flag*/)
 {
     mRenderNodeUpdate = true;
@@ -1272,7 +1637,7 @@ renderer::Fill::Fill(model::Fill *data)
     mDrawable.setName(mModel.name());
 }
 
-bool renderer::Fill::updateContent(int frameNo, const VMatrix &, float alpha)
+bool renderer::Fill::updateContent(float frameNo, const VMatrix &, float alpha)
 {
     auto combinedAlpha = alpha * mModel.opacity(frameNo);
     auto color = mModel.color(frameNo).toColor(combinedAlpha);
@@ -1290,7 +1655,7 @@ renderer::GradientFill::GradientFill(model::GradientFill *data)
     mDrawable.setName(mData->name());
 }
 
-bool renderer::GradientFill::updateContent(int frameNo, const VMatrix &matrix,
+bool renderer::GradientFill::updateContent(float frameNo, const VMatrix &matrix,
                                            float alpha)
 {
     float combinedAlpha = alpha * mData->opacity(frameNo);
@@ -1317,7 +1682,7 @@ renderer::Stroke::Stroke(model::Stroke *data)
 
 static vthread_local std::vector<float> Dash_Vector;
 
-bool renderer::Stroke::updateContent(int frameNo, const VMatrix &matrix,
+bool renderer::Stroke::updateContent(float frameNo, const VMatrix &matrix,
                                      float alpha)
 {
     auto combinedAlpha = alpha * mModel.opacity(frameNo);
@@ -1353,7 +1718,7 @@ renderer::GradientStroke::GradientStroke(model::GradientStroke *data)
     }
 }
 
-bool renderer::GradientStroke::updateContent(int frameNo, const VMatrix &matrix,
+bool renderer::GradientStroke::updateContent(float frameNo, const VMatrix &matrix,
                                              float alpha)
 {
     float combinedAlpha = alpha * mData->opacity(frameNo);
@@ -1393,7 +1758,7 @@ bool renderer::Trim::resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
     return false;
 }
 
-void renderer::Trim::update(int frameNo, const VMatrix & /*parentMatrix*/,
+void renderer::Trim::update(float frameNo, const VMatrix & /*parentMatrix*/,
                             float /*parentAlpha*/, const DirtyFlag & /*flag*/)
 {
     mDirty = false;
@@ -1430,9 +1795,10 @@ void renderer::Trim::update()
     }
 
     if (mData->type() == model::Trim::TrimType::Simultaneously) {
-        for (auto &i : mPathItems) {
-            mPathMesure.setRange(mCache.mSegment.start, mCache.mSegment.end);
-            i->updatePath(mPathMesure.trim(i->localPath()));
+        for (size_t n = 0; n < mPathItems.size(); n++) {
+            auto &i = mPathItems[n];
+            mPathMesure[n].setRange(mCache.mSegment.start, mCache.mSegment.end);
+            i->updatePath(mPathMesure[n].trim(i->localPath()));
         }
     } else {  // model::Trim::TrimType::Individually
         float totalLength = 0.0;
@@ -1444,7 +1810,8 @@ void renderer::Trim::update()
 
         if (start < end) {
             float curLen = 0.0;
-            for (auto &i : mPathItems) {
+            for (size_t n = 0; n < mPathItems.size(); n++) {
+                auto &i = mPathItems[n];
                 if (curLen > end) {
                     // update with empty path.
                     i->updatePath(VPath());
@@ -1458,7 +1825,9 @@ void renderer::Trim::update()
                     i->updatePath(VPath());
                     continue;
                 } else if (start <= curLen && end >= curLen + len) {
-                    // inside segment
+                    // inside segment, mark it dirty as the previous
+                    // frame may have left a trimmed path behind.
+                    i->updatePath(i->localPath());
                     curLen += len;
                     continue;
                 } else {
@@ -1466,11 +1835,41 @@ void renderer::Trim::update()
                     local_start /= len;
                     float local_end = curLen + len < end ? len : end - curLen;
                     local_end /= len;
-                    mPathMesure.setRange(local_start, local_end);
-                    i->updatePath(mPathMesure.trim(i->localPath()));
+                    mPathMesure[n].setRange(local_start, local_end);
+                    i->updatePath(mPathMesure[n].trim(i->localPath()));
                     curLen += len;
                 }
             }
+        } else {
+            // looping segment, keeps [start, totalLength] and [0, end].
+            float curLen = 0.0;
+            for (size_t n = 0; n < mPathItems.size(); n++) {
+                auto &i = mPathItems[n];
+                float len = i->localPath().length();
+                bool  head = curLen < end;
+                bool  tail = curLen + len > start;
+
+                if (!head && !tail) {
+                    i->updatePath(VPath());
+                } else if (vIsZero(len)) {
+                    i->updatePath(i->localPath());
+                } else {
+                    // the head part always begins at the path start and
+                    // the tail part always stops at the path end, when both
+                    // are there the path is trimmed as a loop.
+                    float local_start =
+                        tail ? std::max(start - curLen, 0.0f) / len : 0.0f;
+                    float local_end =
+                        head ? std::min(end - curLen, len) / len : 1.0f;
+                    if (head && tail && local_start <= local_end) {
+                        local_start = 0.0f;
+                        local_end = 1.0f;
+                    }
+                    mPathMesure[n].setRange(local_start, local_end);
+                    i->updatePath(mPathMesure[n].trim(i->localPath()));
+                }
+                curLen += len;
+            }
         }
     }
 }
@@ -1480,6 +1879,7 @@ void renderer::Trim::addPathItems(std::vector<renderer::Shape *> &list,
 {
     std::copy(list.begin() + startOffset, list.end(),
               back_inserter(mPathItems));
+    mPathMesure.resize(mPathItems.size());
 }
 
 renderer::Repeater::Repeater(model::Repeater *data, VArenaAlloc *allocator)
@@ -1489,15 +1889,50 @@ renderer::Repeater::Repeater(model::Repeater *data, VArenaAlloc *allocator)
 
     mCopies = mRepeaterData->maxCopies();
 
+    std::vector<renderer::Shape *> shapes;
     for (int i = 0; i < mCopies; i++) {
         auto content = allocator->make<renderer::Group>(
             mRepeaterData->content(), allocator);
         // content->setParent(this);
         mContents.push_back(content);
+        content->collectContent(shapes, mPaints);
+        if (i == 0) mPaintCount = mPaints.size();
     }
+
+    // every copy is built from the same content, so they evaluate the same
+    // local paths. only the first copy does it.
+    size_t shapeCount = mCopies ? shapes.size() / mCopies : 0;
+    for (size_t i = shapeCount; i < shapes.size(); i++)
+        shapes[i]->shareLocalPath(shapes[i % shapeCount]);
+}
+
+/*
+ * a copy that only moves by whole pixels compared to the first one has the
+ * same coverage moved by that offset. rasterization is translation
+ * invariant only for whole pixels, anything else is rasterized again.
+ */
+static bool pixelOffset(const VMatrix &first, const VMatrix &copy,
+                        VPoint &offset)
+{
+    if (first.m_11() != copy.m_11() || first.m_12() != copy.m_12() ||
+        first.m_21() != copy.m_21() || first.m_22() != copy.m_22() ||
+        first.m_13() != copy.m_13() || first.m_23() != copy.m_23() ||
+        first.m_33() != copy.m_33())
+        return false;
+
+    float dx = copy.m_tx() - first.m_tx();
+    float dy = copy.m_ty() - first.m_ty();
+    float x = std::round(dx);
+    float y = std::round(dy);
+    // well below the 1/256 pixel precision of the rasterizer.
+    if (std::fabs(dx - x) > 1.0f / 1024 || std::fabs(dy - y) > 1.0f / 1024)
+        return false;
+
+    offset = VPoint(int(x), int(y));
+    return true;
 }
 
-void renderer::Repeater::update(int frameNo, const VMatrix &parentMatrix,
+void renderer::Repeater::update(float frameNo, const VMatrix &parentMatrix,
                                 float parentAlpha, const DirtyFlag &flag)
 {
     DirtyFlag newFlag = flag;
@@ -1520,6 +1955,7 @@ void renderer::Repeater::update(int frameNo, const VMatrix &parentMatrix,
 
     newFlag |= DirtyFlagBit::Alpha;
 
+    VMatrix first;
     for (int i = 0; i < mCopies; ++i) {
         float newAlpha =
             parentAlpha * lerp(startOpacity, endOpacity, i / copies);
@@ -1530,6 +1966,20 @@ void renderer::Repeater::update(int frameNo, const VMatrix &parentMatrix,
         VMatrix result = mRepeaterData->mTransform.matrix(frameNo, i + offset) *
                          parentMatrix;
         mContents[i]->update(frameNo, result, newAlpha, newFlag);
+
+        if (i == 0) {
+            first = result;
+            continue;
+        }
+
+        // trimmed paths may differ between the copies.
+        VPoint delta;
+        bool   instance =
+            !mRepeaterData->mTrimmed && pixelOffset(first, result, delta);
+        for (size_t k = 0; k < mPaintCount; k++) {
+            mPaints[i * mPaintCount + k]->setInstance(
+                instance ? mPaints[k] : nullptr, delta);
+        }
     }
 }
 
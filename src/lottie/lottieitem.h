@@ -23,7 +23,9 @@
 #ifndef LOTTIEITEM_H
 #define LOTTIEITEM_H
 
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 
 #include "lottiekeypath.h"
@@ -88,27 +90,54 @@ enum class DirtyFlagBit : uint8_t {
 };
 typedef vFlag<DirtyFlagBit> DirtyFlag;
 
-class SurfaceCache {
+/*
+ * Offscreen bitmaps shared by all the animations. Released surfaces are
+ * kept by size class so the next frame (or another animation) reuses
+ * them instead of allocating, up to a byte budget.
+ */
+class SurfacePool {
 public:
-    SurfaceCache() { mCache.reserve(10); }
+    static SurfacePool &instance()
+    {
+        static SurfacePool singleton;
+        return singleton;
+    }
+
+    VBitmap acquire(size_t width, size_t height, VBitmap::Format format);
+    void    release(VBitmap &&surface);
+    // budget of the free surfaces, 0 disables the reuse.
+    void    setBudget(size_t bytes);
+    // drops all the free surfaces.
+    void    purge();
+    rlottie::SurfaceCacheStats stats();
 
+private:
+    SurfacePool() = default;
+    void          trim(size_t budget);
+    static size_t sizeClass(size_t bytes);
+
+    std::map<size_t, std::vector<VBitmap>> mFree;  // by size class
+    std::mutex                             mMutex;
+    size_t                                 mBudget{32 * 1024 * 1024};
+    size_t                                 mFreeBytes{0};
+    size_t                                 mLiveBytes{0};  // in use + free
+    rlottie::SurfaceCacheStats             mStats;
+};
+
+class SurfaceCache {
+public:
     VBitmap make_surface(
         size_t width, size_t height,
         VBitmap::Format format = VBitmap::Format::ARGB32_Premultiplied)
     {
-        if (mCache.empty()) return {width, height, format};
-
-        auto surface = mCache.back();
-        surface.reset(width, height, format);
-
-        mCache.pop_back();
-        return surface;
+        return SurfacePool::instance().acquire(width, height, format);
     }
 
-    void release_surface(VBitmap &surface) { mCache.push_back(surface); }
-
-private:
-    std::vector<VBitmap> mCache;
+    // the surface is handed back to the pool and left empty.
+    void release_surface(VBitmap &surface)
+    {
+        SurfacePool::instance().release(std::move(surface));
+    }
 };
 
 class Drawable final : public VDrawable {
@@ -117,6 +146,7 @@ public:
 
 public:
     std::unique_ptr<LOTNode> mCNode{nullptr};
+    VPath                    mDashedPath;  // dashed mPath for the c node
 
     ~Drawable() noexcept
     {
@@ -137,7 +167,7 @@ class Clipper {
 public:
     explicit Clipper(VSize size) : mSize(size) {}
     void update(const VMatrix &matrix);
-    void preprocess(const VRect &clip);
+    void preprocess(const VRect &clip, float flatness);
     VRle rle(const VRle &mask);
 
 public:
@@ -151,11 +181,11 @@ public:
 class Mask {
 public:
     explicit Mask(model::Mask *data) : mData(data) {}
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag);
     model::Mask::Mode maskMode() const { return mData->mMode; }
     VRle              rle();
-    void              preprocess(const VRect &clip);
+    void              preprocess(const VRect &clip, float flatness);
     bool              inverted() const { return mData->mInv; }
 public:
     model::Mask *mData{nullptr};
@@ -172,11 +202,11 @@ public:
 class LayerMask {
 public:
     explicit LayerMask(model::Layer *layerData);
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag);
     bool isStatic() const { return mStatic; }
     VRle maskRle(const VRect &clipRect);
-    void preprocess(const VRect &clip);
+    void preprocess(const VRect &clip, float flatness);
 
 public:
     std::vector<Mask> mMasks;
@@ -190,12 +220,18 @@ class Layer;
 class Composition {
 public:
     explicit Composition(std::shared_ptr<model::Composition> composition);
-    bool  update(int frameNo, const VSize &size, bool keepAspectRatio);
+    bool  update(float frameNo, const VSize &size, bool keepAspectRatio);
     VSize size() const { return mViewSize; }
     void  buildRenderTree();
     const LOTLayerNode *renderTree() const;
     bool                render(const rlottie::Surface &surface);
     void                setValue(const std::string &keypath, LOTVariant &value);
+    void setRenderQuality(rlottie::RenderQuality quality) { mQuality = quality; }
+    void setImageFilter(rlottie::ImageFilter filter);
+    rlottie::RenderStats renderStats() const { return mRenderStats; }
+
+private:
+    float flatness() const;
 
 private:
     SurfaceCache                        mSurfaceCache;
@@ -205,7 +241,10 @@ private:
     std::shared_ptr<model::Composition> mModel;
     Layer *                             mRootLayer{nullptr};
     VArenaAlloc                         mAllocator{2048};
-    int                                 mCurFrameNo;
+    float                               mCurFrameNo;
+    float                  mFlatness{VRasterizer::DefaultFlatness};
+    rlottie::RenderQuality mQuality{rlottie::RenderQuality::Auto};
+    rlottie::RenderStats   mRenderStats;
     bool                                mKeepAspectRatio{true};
     bool                                mHasDynamicValue{false};
 };
@@ -220,14 +259,30 @@ public:
     void         setParentLayer(Layer *parent) { mParentLayer = parent; }
     void         setComplexContent(bool value) { mComplexContent = value; }
     bool         complexContent() const { return mComplexContent; }
-    virtual void update(int frameNo, const VMatrix &parentMatrix,
+    virtual void update(float frameNo, const VMatrix &parentMatrix,
                         float parentAlpha);
-    VMatrix      matrix(int frameNo) const;
-    void         preprocess(const VRect &clip);
+    // forces the content to be regenerated in the next update.
+    virtual void invalidate() { mDirtyFlag = DirtyFlagBit::All; }
+    virtual void setImageFilter(rlottie::ImageFilter) {}
+    VMatrix      matrix(float frameNo) const;
+    void         preprocess(const VRect &clip, float flatness);
     virtual DrawableList renderList() { return {}; }
+    // area the layer draws into this frame, sizes offscreen surfaces
+    virtual VRect        drawBounds();
     virtual void         render(VPainter *painter, const VRle &mask,
                                 const VRle &matteRle, SurfaceCache &cache);
-    bool                 hasMatte()
+    // alpha of the layer as a single rle when it only paints solid colors,
+    // returns false when it has to be rendered into a bitmap.
+    bool                 coverage(const VRle &mask, const VRect &clip,
+                                  VRle &result);
+    // true if the layer alone paints every pixel of area opaque, the
+    // layers below it don't show there.
+    bool                 occludes(const VRect &area);
+    bool                 precompLayer() const
+    {
+        return mLayerData->precompLayer();
+    }
+    bool                 hasMatte() const
     {
         if (mLayerData->mMatteType == model::MatteType::None) return false;
         return true;
@@ -244,13 +299,13 @@ public:
                                 LOTVariant &value);
 
 protected:
-    virtual void   preprocessStage(const VRect &clip) = 0;
+    virtual void   preprocessStage(const VRect &clip, float flatness) = 0;
     virtual void   updateContent() = 0;
     inline VMatrix combinedMatrix() const { return mCombinedMatrix; }
-    inline int     frameNo() const { return mFrameNo; }
+    inline float   frameNo() const { return mFrameNo; }
     inline float   combinedAlpha() const { return mCombinedAlpha; }
     inline bool    isStatic() const { return mLayerData->isStatic(); }
-    float opacity(int frameNo) const { return mLayerData->opacity(frameNo); }
+    float opacity(float frameNo) const { return mLayerData->opacity(frameNo); }
     inline DirtyFlag flag() const { return mDirtyFlag; }
     bool             skipRendering() const
     {
@@ -263,7 +318,7 @@ protected:
     Layer *                    mParentLayer{nullptr};
     VMatrix                    mCombinedMatrix;
     float                      mCombinedAlpha{0.0};
-    int                        mFrameNo{-1};
+    float                      mFrameNo{-1};
     DirtyFlag                  mDirtyFlag{DirtyFlagBit::All};
     bool                       mComplexContent{false};
     std::unique_ptr<CApiData>  mCApiData;
@@ -273,25 +328,56 @@ class CompLayer final : public Layer {
 public:
     explicit CompLayer(model::Layer *layerData, VArenaAlloc *allocator);
 
-    void render(VPainter *painter, const VRle &mask, const VRle &matteRle,
-                SurfaceCache &cache) final;
-    void buildLayerNode() final;
-    bool resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
-                        LOTVariant &value) override;
+    void  render(VPainter *painter, const VRle &mask, const VRle &matteRle,
+                 SurfaceCache &cache) final;
+    VRect drawBounds() final;
+    void  buildLayerNode() final;
+    bool  resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
+                         LOTVariant &value) override;
+    void  invalidate() final;
+    void  setImageFilter(rlottie::ImageFilter filter) final;
+    // finds the layers hidden by an opaque one, front to back. With
+    // preprocess set the layers are preprocessed on the way, otherwise
+    // they must have been preprocessed already.
+    void   cullOccluded(const VRect &clip, float flatness, bool preprocess);
+    // layers drawn and hidden by opaque ones in the last cullOccluded().
+    size_t drawnLayers() const { return mDrawnLayers; }
+    size_t culledLayers() const { return mCulledLayers; }
 
 protected:
-    void preprocessStage(const VRect &clip) final;
+    void preprocessStage(const VRect &clip, float flatness) final;
     void updateContent() final;
 
 private:
+    void cullLayer(Layer *layer, bool cull, const VRect &clip, float flatness,
+                   bool preprocess);
     void renderHelper(VPainter *painter, const VRle &mask, const VRle &matteRle,
                       SurfaceCache &cache);
     void renderMatteLayer(VPainter *painter, const VRle &inheritMask,
                           const VRle &matteRle, Layer *layer, Layer *src,
                           SurfaceCache &cache);
+    // matte of the layer at index, nullptr if it has none.
+    Layer *matteLayer(size_t index) const
+    {
+        return (index && mLayers[index - 1]->hasMatte()) ? mLayers[index - 1]
+                                                         : nullptr;
+    }
 
 private:
     std::vector<Layer *>     mLayers;
+    // sorted in and out frames of mLayers. The number of layers started
+    // and ended at a frame identifies the set of visible layers, only
+    // those are walked until it changes.
+    std::vector<int>         mInFrames;
+    std::vector<int>         mOutFrames;
+    std::vector<size_t>      mActiveLayers;  // indices in mLayers
+    std::pair<size_t, size_t> mActiveKey{SIZE_MAX, SIZE_MAX};
+    // mActiveLayers below this one are hidden by an opaque layer.
+    size_t                   mDrawnFrom{0};
+    size_t                   mDrawnLayers{0};   // nested ones included
+    size_t                   mCulledLayers{0};  // nested ones included
+    // false if the children get a mask with soft edges from above.
+    bool                     mCullOccluded{true};
     std::unique_ptr<Clipper> mClipper;
 };
 
@@ -302,7 +388,7 @@ public:
     DrawableList renderList() final;
 
 protected:
-    void preprocessStage(const VRect &clip) final;
+    void preprocessStage(const VRect &clip, float flatness) final;
     void updateContent() final;
 
 private:
@@ -324,7 +410,8 @@ public:
                         SurfaceCache &cache) final;
 
 protected:
-    void                     preprocessStage(const VRect &clip) final;
+    void                     preprocessStage(const VRect &clip,
+                                             float        flatness) final;
     void                     updateContent() final;
     std::vector<VDrawable *> mDrawableList;
     Group *                  mRoot{nullptr};
@@ -335,7 +422,7 @@ public:
     explicit NullLayer(model::Layer *layerData);
 
 protected:
-    void preprocessStage(const VRect &) final {}
+    void preprocessStage(const VRect &, float) final {}
     void updateContent() final;
 };
 
@@ -344,9 +431,13 @@ public:
     explicit ImageLayer(model::Layer *layerData);
     void         buildLayerNode() final;
     DrawableList renderList() final;
+    void         setImageFilter(rlottie::ImageFilter filter) final
+    {
+        mTexture.mBilinear = filter == rlottie::ImageFilter::Bilinear;
+    }
 
 protected:
-    void preprocessStage(const VRect &clip) final;
+    void preprocessStage(const VRect &clip, float flatness) final;
     void updateContent() final;
 
 private:
@@ -361,7 +452,7 @@ public:
     enum class Type : uint8_t { Unknown, Group, Shape, Paint, Trim };
     virtual ~Object() = default;
     Object &     operator=(Object &&) noexcept = delete;
-    virtual void update(int frameNo, const VMatrix &parentMatrix,
+    virtual void update(float frameNo, const VMatrix &parentMatrix,
                         float parentAlpha, const DirtyFlag &flag) = 0;
     virtual void renderList(std::vector<VDrawable *> &) {}
     virtual bool resolveKeyPath(LOTKeyPath &, uint32_t, LOTVariant &)
@@ -372,16 +463,20 @@ public:
 };
 
 class Shape;
+class Paint;
 class Group : public Object {
 public:
     Group() = default;
     explicit Group(model::Group *data, VArenaAlloc *allocator);
     void addChildren(model::Group *data, VArenaAlloc *allocator);
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag) override;
     void applyTrim();
     void processTrimItems(std::vector<Shape *> &list);
     void processPaintItems(std::vector<Shape *> &list);
+    // shapes and paints in drawing order, repeater copies included.
+    void collectContent(std::vector<Shape *> &shapes,
+                        std::vector<Paint *> &paints);
     void renderList(std::vector<VDrawable *> &list) override;
     Object::Type   type() const final { return Object::Type::Group; }
     const VMatrix &matrix() const { return mMatrix; }
@@ -404,7 +499,7 @@ private:
 class Shape : public Object {
 public:
     Shape(bool staticPath) : mStaticPath(staticPath) {}
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag) final;
     Object::Type type() const final { return Object::Type::Shape; }
     bool         dirty() const { return mDirtyPath; }
@@ -418,24 +513,28 @@ public:
     bool   staticPath() const { return mStaticPath; }
     void   setParent(Group *parent) { mParent = parent; }
     Group *parent() const { return mParent; }
+    // takes the local path of source (updated first) instead of
+    // evaluating the same path again.
+    void   shareLocalPath(Shape *source) { mSource = source; }
 
 protected:
-    virtual void updatePath(VPath &path, int frameNo) = 0;
-    virtual bool hasChanged(int prevFrame, int curFrame) = 0;
+    virtual void updatePath(VPath &path, float frameNo) = 0;
+    virtual bool hasChanged(float prevFrame, float curFrame) = 0;
 
 private:
-    bool hasChanged(int frameNo)
+    bool hasChanged(float frameNo)
     {
-        int prevFrame = mFrameNo;
+        float prevFrame = mFrameNo;
         mFrameNo = frameNo;
         if (prevFrame == -1) return true;
         if (mStaticPath || (prevFrame == frameNo)) return false;
         return hasChanged(prevFrame, frameNo);
     }
     Group *mParent{nullptr};
+    Shape *mSource{nullptr};
     VPath  mLocalPath;
     VPath  mTemp;
-    int    mFrameNo{-1};
+    float  mFrameNo{-1};
     bool   mDirtyPath{true};
     bool   mStaticPath;
 };
@@ -445,10 +544,10 @@ public:
     explicit Rect(model::Rect *data);
 
 protected:
-    void         updatePath(VPath &path, int frameNo) final;
+    void         updatePath(VPath &path, float frameNo) final;
     model::Rect *mData{nullptr};
 
-    bool hasChanged(int prevFrame, int curFrame) final
+    bool hasChanged(float prevFrame, float curFrame) final
     {
         return (mData->mPos.changed(prevFrame, curFrame) ||
                 mData->mSize.changed(prevFrame, curFrame) ||
@@ -461,9 +560,9 @@ public:
     explicit Ellipse(model::Ellipse *data);
 
 private:
-    void            updatePath(VPath &path, int frameNo) final;
+    void            updatePath(VPath &path, float frameNo) final;
     model::Ellipse *mData{nullptr};
-    bool            hasChanged(int prevFrame, int curFrame) final
+    bool            hasChanged(float prevFrame, float curFrame) final
     {
         return (mData->mPos.changed(prevFrame, curFrame) ||
                 mData->mSize.changed(prevFrame, curFrame));
@@ -475,9 +574,9 @@ public:
     explicit Path(model::Path *data);
 
 private:
-    void         updatePath(VPath &path, int frameNo) final;
+    void         updatePath(VPath &path, float frameNo) final;
     model::Path *mData{nullptr};
-    bool         hasChanged(int prevFrame, int curFrame) final
+    bool         hasChanged(float prevFrame, float curFrame) final
     {
         return mData->mShape.changed(prevFrame, curFrame);
     }
@@ -488,10 +587,10 @@ public:
     explicit Polystar(model::Polystar *data);
 
 private:
-    void             updatePath(VPath &path, int frameNo) final;
+    void             updatePath(VPath &path, float frameNo) final;
     model::Polystar *mData{nullptr};
 
-    bool hasChanged(int prevFrame, int curFrame) final
+    bool hasChanged(float prevFrame, float curFrame) final
     {
         return (mData->mPos.changed(prevFrame, curFrame) ||
                 mData->mPointCount.changed(prevFrame, curFrame) ||
@@ -507,13 +606,19 @@ class Paint : public Object {
 public:
     Paint(bool staticContent);
     void addPathItems(std::vector<Shape *> &list, size_t startOffset);
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag) override;
     void renderList(std::vector<VDrawable *> &list) final;
     Object::Type type() const final { return Object::Type::Paint; }
+    // draws the coverage of source moved by offset, see
+    // VDrawable::setInstance().
+    void setInstance(Paint *source, const VPoint &offset)
+    {
+        mDrawable.setInstance(source ? &source->mDrawable : nullptr, offset);
+    }
 
 protected:
-    virtual bool updateContent(int frameNo, const VMatrix &matrix,
+    virtual bool updateContent(float frameNo, const VMatrix &matrix,
                                float alpha) = 0;
 
 private:
@@ -534,7 +639,7 @@ public:
     explicit Fill(model::Fill *data);
 
 protected:
-    bool updateContent(int frameNo, const VMatrix &matrix, float alpha) final;
+    bool updateContent(float frameNo, const VMatrix &matrix, float alpha) final;
     bool resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
                         LOTVariant &value) final;
 
@@ -547,7 +652,7 @@ public:
     explicit GradientFill(model::GradientFill *data);
 
 protected:
-    bool updateContent(int frameNo, const VMatrix &matrix, float alpha) final;
+    bool updateContent(float frameNo, const VMatrix &matrix, float alpha) final;
 
 private:
     model::GradientFill *      mData{nullptr};
@@ -559,7 +664,7 @@ public:
     explicit Stroke(model::Stroke *data);
 
 protected:
-    bool updateContent(int frameNo, const VMatrix &matrix, float alpha) final;
+    bool updateContent(float frameNo, const VMatrix &matrix, float alpha) final;
     bool resolveKeyPath(LOTKeyPath &keyPath, uint32_t depth,
                         LOTVariant &value) final;
 
@@ -572,7 +677,7 @@ public:
     explicit GradientStroke(model::GradientStroke *data);
 
 protected:
-    bool updateContent(int frameNo, const VMatrix &matrix, float alpha) final;
+    bool updateContent(float frameNo, const VMatrix &matrix, float alpha) final;
 
 private:
     model::GradientStroke *    mData{nullptr};
@@ -582,7 +687,7 @@ private:
 class Trim final : public Object {
 public:
     explicit Trim(model::Trim *data) : mData(data), mModel(data) {}
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag) final;
     Object::Type type() const final { return Object::Type::Trim; }
     void         update();
@@ -600,13 +705,14 @@ private:
         return false;
     }
     struct Cache {
-        int                  mFrameNo{-1};
+        float                mFrameNo{-1};
         model::Trim::Segment mSegment{};
     };
     Cache                mCache;
     std::vector<Shape *> mPathItems;
     model::Trim *        mData{nullptr};
-    VPathMesure          mPathMesure;
+    // one per path item, each keeps the length table of its own path.
+    std::vector<VPathMesure> mPathMesure;
     bool                 mDirty{true};
 
     model::Filter<model::Trim> mModel;
@@ -615,14 +721,16 @@ private:
 class Repeater final : public Group {
 public:
     explicit Repeater(model::Repeater *data, VArenaAlloc *allocator);
-    void update(int frameNo, const VMatrix &parentMatrix, float parentAlpha,
+    void update(float frameNo, const VMatrix &parentMatrix, float parentAlpha,
                 const DirtyFlag &flag) final;
     void renderList(std::vector<VDrawable *> &list) final;
 
 private:
-    model::Repeater *mRepeaterData{nullptr};
-    bool             mHidden{false};
-    int              mCopies{0};
+    model::Repeater *    mRepeaterData{nullptr};
+    std::vector<Paint *> mPaints;  // mPaintCount per copy
+    size_t               mPaintCount{0};
+    bool                 mHidden{false};
+    int                  mCopies{0};
 };
 
 }  // namespace renderer
@@ -236,9 +236,19 @@ void renderer::Drawable::sync()
     if (mFlag & DirtyState::None) return;
 
     if (mFlag & DirtyState::Path) {
-        applyDashOp();
-        const std::vector<VPath::Element> &elm = mPath.elements();
-        const std::vector<VPointF> &       pts = mPath.points();
+        // dash into a path of our own, mPath must stay undashed as the
+        // rasterizer dashes it again when the frame gets rendered.
+        const VPath *path = &mPath;
+        if (mType == Type::StrokeWithDash) {
+            auto obj = static_cast<StrokeWithDashInfo *>(mStrokeInfo);
+            if (!obj->mDash.empty()) {
+                VDasher dasher(obj->mDash.data(), obj->mDash.size());
+                dasher.dashed(mPath, mDashedPath);
+                path = &mDashedPath;
+            }
+        }
+        const std::vector<VPath::Element> &elm = path->elements();
+        const std::vector<VPointF> &       pts = path->points();
         const float *ptPtr = reinterpret_cast<const float *>(pts.data());
         const char * elmPtr = reinterpret_cast<const char *>(elm.data());
         mCNode->mPath.elmPtr = elmPtr;
@@ -108,6 +108,17 @@ static std::string dirname(const std::string &path)
     return std::string(path, 0, len);
 }
 
+/*
+ * The easing mode is fixed into the interpolators at parse time, so a
+ * model parsed in table mode can't be handed to an exact mode load.
+ * Paths and keys don't contain a '\0', the suffix can't collide.
+ */
+static std::string cacheKey(const std::string &key)
+{
+    if (VInterpolator::mode() == VInterpolator::Mode::Exact) return key;
+    return key + std::string(1, '\0') + "table";
+}
+
 void model::configureModelCacheSize(size_t cacheSize)
 {
     ModelCache::instance().configureCacheSize(cacheSize);
@@ -116,8 +127,9 @@ void model::configureModelCacheSize(size_t cacheSize)
 std::shared_ptr<model::Composition> model::loadFromFile(const std::string &path,
                                                         bool cachePolicy)
 {
+    auto key = cacheKey(path);
     if (cachePolicy) {
-        auto obj = ModelCache::instance().find(path);
+        auto obj = ModelCache::instance().find(key);
         if (obj) return obj;
     }
 
@@ -144,7 +156,7 @@ std::shared_ptr<model::Composition> model::loadFromFile(const std::string &path,
         auto obj = internal::model::parse(const_cast<char *>(content.c_str()), fsize,
                                           dirname(path));
 
-        if (obj && cachePolicy) ModelCache::instance().add(path, obj);
+        if (obj && cachePolicy) ModelCache::instance().add(key, obj);
 
         return obj;
     }
@@ -154,15 +166,16 @@ std::shared_ptr<model::Composition> model::loadFromData(
     std::string jsonData, const std::string &key, std::string resourcePath,
     bool cachePolicy)
 {
+    auto modeKey = cacheKey(key);
     if (cachePolicy) {
-        auto obj = ModelCache::instance().find(key);
+        auto obj = ModelCache::instance().find(modeKey);
         if (obj) return obj;
     }
 
     auto obj = internal::model::parse(const_cast<char *>(jsonData.c_str()), jsonData.size(),
                                       std::move(resourcePath));
 
-    if (obj && cachePolicy) ModelCache::instance().add(key, obj);
+    if (obj && cachePolicy) ModelCache::instance().add(modeKey, obj);
 
     return obj;
 }
@@ -22,11 +22,24 @@
 
 #include "lottiemodel.h"
 #include <cassert>
+#include <cstdio>
 #include <iterator>
+#include <limits>
 #include <stack>
+#include "config.h"
 #include "vimageloader.h"
 #include "vline.h"
 
+#ifdef LOTTIE_THREAD_SUPPORT
+#include <thread>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 using namespace rlottie::internal;
 
 /*
@@ -56,6 +69,7 @@ public:
                 if (repeater->processed()) continue;
 
                 repeater->markProcessed();
+                repeater->mTrimmed = mTrimmed;
 
                 auto content = repeater->content();
                 // 1. increment the reverse iterator to point to the
@@ -80,30 +94,44 @@ public:
     void visit(model::Object *obj)
     {
         switch (obj->type()) {
-        case model::Object::Type::Group:
+        case model::Object::Type::Group: {
+            visitChildren(static_cast<model::Group *>(obj));
+            break;
+        }
         case model::Object::Type::Layer: {
+            bool trimmed = mTrimmed;
+            mTrimmed = static_cast<model::Layer *>(obj)->hasPathOperator();
             visitChildren(static_cast<model::Group *>(obj));
+            mTrimmed = trimmed;
             break;
         }
         default:
             break;
         }
     }
+
+private:
+    bool mTrimmed{false};  // the visited layer has path operators
 };
 
+/*
+ * walks the layer tree the way the renderer will see it. [first, last]
+ * is the frame range a layer list is drawn at, in the list's own time,
+ * layers entirely outside of it are never drawn and are not visited.
+ */
 class LottieUpdateStatVisitor {
     model::Composition::Stats *stat;
 
 public:
     explicit LottieUpdateStatVisitor(model::Composition::Stats *s) : stat(s) {}
-    void visitChildren(model::Group *obj)
+    void visitLayer(model::Layer *layer, float first, float last,
+                    bool translucent)
     {
-        for (const auto &child : obj->mChildren) {
-            if (child) visit(child);
+        if (layer->inFrame() > last || layer->outFrame() < first) {
+            stat->hiddenLayerCount++;
+            return;
         }
-    }
-    void visitLayer(model::Layer *layer)
-    {
+
         switch (layer->mLayerType) {
         case model::Layer::Type::Precomp:
             stat->precompLayerCount++;
@@ -123,25 +151,51 @@ public:
         default:
             break;
         }
-        visitChildren(layer);
-    }
-    void visit(model::Object *obj)
-    {
-        switch (obj->type()) {
-        case model::Object::Type::Layer: {
-            visitLayer(static_cast<model::Layer *>(obj));
-            break;
-        }
-        case model::Object::Type::Repeater: {
-            visitChildren(static_cast<model::Repeater *>(obj)->content());
-            break;
+        if (layer->isStatic()) stat->staticLayerCount++;
+        if (layer->hasMask()) stat->maskLayerCount++;
+        if (layer->mMatteType != model::MatteType::None)
+            stat->matteLayerCount++;
+
+        // alpha is inherited from the parent composition, see
+        // renderer::Layer::combinedAlpha()
+        if (layer->mTransform && layer->mTransform->translucent())
+            translucent = true;
+
+        size_t children = std::count_if(
+            layer->mChildren.begin(), layer->mChildren.end(),
+            [](const model::Object *obj) {
+                return obj && obj->type() == model::Object::Type::Layer;
+            });
+
+        // mirrors the offscreen decisions in lottieitem.cpp
+        bool offscreen = layer->mMatteType != model::MatteType::None;
+        if (translucent) {
+            if (layer->mLayerType == model::Layer::Type::Shape)
+                offscreen = true;
+            else if (layer->precompLayer() && children > 1)
+                offscreen = true;
         }
-        case model::Object::Type::Group: {
-            visitChildren(static_cast<model::Group *>(obj));
-            break;
+        if (offscreen) stat->offscreenLayerCount++;
+
+        if (!layer->precompLayer() || !children) return;
+
+        // a composition drawn offscreen applies the alpha itself
+        if (children > 1) translucent = false;
+
+        first = std::max(first, float(layer->inFrame()));
+        last = std::min(last, float(layer->outFrame()));
+        if (!layer->mExtra || layer->mExtra->mTimeRemap.isStatic()) {
+            first = (first - layer->startFrame()) / layer->mTimeStreatch;
+            last = (last - layer->startFrame()) / layer->mTimeStreatch;
+        } else {
+            first = -std::numeric_limits<float>::max();
+            last = std::numeric_limits<float>::max();
         }
-        default:
-            break;
+
+        for (const auto &child : layer->mChildren) {
+            if (child && child->type() == model::Object::Type::Layer)
+                visitLayer(static_cast<model::Layer *>(child), first, last,
+                           translucent);
         }
     }
 };
@@ -155,10 +209,39 @@ void model::Composition::processRepeaterObjects()
 void model::Composition::updateStats()
 {
     LottieUpdateStatVisitor visitor(&mStats);
-    visitor.visit(mRootLayer);
+
+    // frames in which at least one top level layer is drawn, empty
+    // (in > out) if none ever is.
+    int in = int(mEndFrame) + 1;
+    int out = int(mStartFrame) - 1;
+    for (const auto &child : mRootLayer->mChildren) {
+        if (!child || child->type() != Object::Type::Layer) continue;
+        auto layer = static_cast<Layer *>(child);
+        visitor.visitLayer(layer, mStartFrame, mEndFrame, false);
+        if (layer->inFrame() > mEndFrame || layer->outFrame() < mStartFrame)
+            continue;
+        in = std::min(in, std::max(layer->inFrame(), int(mStartFrame)));
+        out = std::max(out, std::min(layer->outFrame(), int(mEndFrame)));
+    }
+    mStats.activeInFrame = in;
+    mStats.activeOutFrame = out;
+}
+
+/*
+ * pre evaluates every animated scalar, point, color and transform matrix
+ * for each frame so rendering turns into table lookups. The tables are
+ * built once and shared by every animation using this model, the values
+ * are the same ones the keyframes would produce.
+ */
+size_t model::Composition::bake()
+{
+    std::call_once(mBakeOnce, [this]() {
+        for (auto obj : mBakeables) mBakedBytes += obj->bake();
+    });
+    return mBakedBytes;
 }
 
-VMatrix model::Repeater::Transform::matrix(int frameNo, float multiplier) const
+VMatrix model::Repeater::Transform::matrix(float frameNo, float multiplier) const
 {
     VPointF scale = mScale.value(frameNo) / 100.f;
     scale.setX(std::pow(scale.x(), multiplier));
@@ -173,7 +256,83 @@ VMatrix model::Repeater::Transform::matrix(int frameNo, float multiplier) const
     return m;
 }
 
-VMatrix model::Transform::Data::matrix(int frameNo, bool autoOrient) const
+/*
+ * bakes every integer frame of the union of the animated property ranges,
+ * outside of it all of them are clamped so the first/last matrix is used.
+ * auto oriented layers also need the path angle and are never baked.
+ */
+size_t model::Transform::Data::bake()
+{
+    if (mBaked.load(std::memory_order_relaxed)) return 0;
+
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    auto  extend = [&lo, &hi](const auto &prop) {
+        if (prop.isStatic() || prop.animation().frames_.empty()) return;
+        const auto &frames = prop.animation().frames_;
+        lo = std::min(lo, frames.front().start_);
+        hi = std::max(hi, frames.back().end_);
+    };
+    extend(mRotation);
+    extend(mScale);
+    extend(mPosition);
+    extend(mAnchor);
+    if (mExtra) {
+        extend(mExtra->m3DRx);
+        extend(mExtra->m3DRy);
+        extend(mExtra->m3DRz);
+        extend(mExtra->mSeparateX);
+        extend(mExtra->mSeparateY);
+    }
+    if (lo > hi) return 0;
+
+    long first = long(std::floor(lo));
+    long last = long(std::ceil(hi));
+    if (last - first >= maxBakedFrames) return 0;
+
+    size_t frames = size_t(last - first + 1);
+    auto   baked = new Baked{first, frames, {}, {}};
+    baked->columns.resize(Baked::Count * frames);
+    baked->types.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+        VMatrix m = computeMatrix(float(first + long(i)), false);
+        float  *col = baked->columns.data() + i;
+        col[Baked::M11 * frames] = m.m_11();
+        col[Baked::M12 * frames] = m.m_12();
+        col[Baked::M13 * frames] = m.m_13();
+        col[Baked::M21 * frames] = m.m_21();
+        col[Baked::M22 * frames] = m.m_22();
+        col[Baked::M23 * frames] = m.m_23();
+        col[Baked::MTX * frames] = m.m_tx();
+        col[Baked::MTY * frames] = m.m_ty();
+        col[Baked::M33 * frames] = m.m_33();
+        baked->types[i] = m.type();
+    }
+    mBaked.store(baked, std::memory_order_release);
+
+    return sizeof(Baked) + baked->columns.size() * sizeof(float) +
+           baked->types.size() * sizeof(VMatrix::MatrixType);
+}
+
+VMatrix model::Transform::Data::matrix(float frameNo, bool autoOrient) const
+{
+    if (!autoOrient && float(long(frameNo)) == frameNo) {
+        if (auto baked = mBaked.load(std::memory_order_acquire)) {
+            long index = long(frameNo) - baked->first;
+            long last = long(baked->frames) - 1;
+            auto i = size_t(std::min(std::max(index, 0L), last));
+            return VMatrix(baked->at(Baked::M11, i), baked->at(Baked::M12, i),
+                           baked->at(Baked::M13, i), baked->at(Baked::M21, i),
+                           baked->at(Baked::M22, i), baked->at(Baked::M23, i),
+                           baked->at(Baked::MTX, i), baked->at(Baked::MTY, i),
+                           baked->at(Baked::M33, i), baked->types[i]);
+        }
+    }
+    return computeMatrix(frameNo, autoOrient);
+}
+
+VMatrix model::Transform::Data::computeMatrix(float frameNo,
+                                              bool autoOrient) const
 {
     VMatrix m;
     VPointF position;
@@ -201,7 +360,7 @@ VMatrix model::Transform::Data::matrix(int frameNo, bool autoOrient) const
     return m;
 }
 
-void model::Dash::getDashInfo(int frameNo, std::vector<float> &result) const
+void model::Dash::getDashInfo(float frameNo, std::vector<float> &result) const
 {
     result.clear();
 
@@ -244,7 +403,7 @@ void model::Dash::getDashInfo(int frameNo, std::vector<float> &result) const
  *     ...
  * ]
  */
-void model::Gradient::populate(VGradientStops &stops, int frameNo)
+void model::Gradient::populate(VGradientStops &stops, float frameNo)
 {
     model::Gradient::Data gradData = mGradient.value(frameNo);
     auto                  size = gradData.mGradient.size();
@@ -293,7 +452,7 @@ float model::Gradient::getOpacityAtPosition(float *opacities, size_t opacityArra
     return 0.0f;
 }
 
-void model::Gradient::update(std::unique_ptr<VGradient> &grad, int frameNo)
+void model::Gradient::update(std::unique_ptr<VGradient> &grad, float frameNo)
 {
     bool init = false;
     if (!grad) {
@@ -346,15 +505,305 @@ void model::Gradient::update(std::unique_ptr<VGradient> &grad, int frameNo)
     }
 }
 
-void model::Asset::loadImageData(std::string data)
+static std::atomic<model::Asset::ImageDecode> ImageDecodeMode{
+    model::Asset::ImageDecode::Lazy};
+
+void model::Asset::setImageDecode(ImageDecode mode)
 {
-    if (!data.empty())
-        mBitmap = VImageLoader::instance().load(data.c_str(), data.length());
+    ImageDecodeMode.store(mode, std::memory_order_relaxed);
+}
+
+model::Asset::ImageDecode model::Asset::imageDecode()
+{
+    return ImageDecodeMode.load(std::memory_order_relaxed);
+}
+
+static constexpr const unsigned char B64index[256] = {
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+    0,  0,  0,  0,  0,  0,  0,  62, 63, 62, 62, 63, 52, 53, 54, 55, 56, 57,
+    58, 59, 60, 61, 0,  0,  0,  0,  0,  0,  0,  0,  1,  2,  3,  4,  5,  6,
+    7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 0,  0,  0,  0,  63, 0,  26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
+    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
+
+static inline void b64decodeQuad(const unsigned char *p, unsigned char *out)
+{
+    int n = B64index[p[0]] << 18 | B64index[p[1]] << 12 | B64index[p[2]] << 6 |
+            B64index[p[3]];
+    out[0] = n >> 16;
+    out[1] = n >> 8 & 0xFF;
+    out[2] = n & 0xFF;
+}
+
+/*
+ * the simd paths only take blocks made of the standard alphabet, anything
+ * else (url safe characters, line breaks, garbage) goes through the table
+ * so the output stays identical to the scalar decoder.
+ */
+#if defined(__SSE2__)
+
+static constexpr size_t kB64Block = 16;
+
+// 16 characters to 12 bytes
+static inline bool b64decodeBlock(const unsigned char *p, unsigned char *out)
+{
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    auto    range = [&c](char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(lo - 1)),
+                             _mm_cmplt_epi8(c, _mm_set1_epi8(hi + 1)));
+    };
+    __m128i upper = range('A', 'Z');
+    __m128i lower = range('a', 'z');
+    __m128i digit = range('0', '9');
+    __m128i plus = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+    __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower),
+                                 _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+    if (_mm_movemask_epi8(valid) != 0xFFFF) return false;
+
+    // per character offset to its 6 bit value
+    __m128i offset = _mm_or_si128(
+        _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+                     _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+        _mm_or_si128(
+            _mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+            _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62 - '+')),
+                         _mm_and_si128(slash, _mm_set1_epi8(63 - '/')))));
+    __m128i v = _mm_add_epi8(c, offset);
+
+    // each 32 bit lane holds a quad, merge its 4 sextets into 24 bits
+    __m128i n = _mm_or_si128(
+        _mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x000000FF)), 18),
+            _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x0000FF00)), 4)),
+        _mm_or_si128(
+            _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x00FF0000)), 10),
+            _mm_srli_epi32(v, 24)));
+    // and swap them to the big endian output order
+    n = _mm_or_si128(
+        _mm_or_si128(_mm_srli_epi32(n, 16),
+                     _mm_and_si128(n, _mm_set1_epi32(0x0000FF00))),
+        _mm_slli_epi32(_mm_and_si128(n, _mm_set1_epi32(0x000000FF)), 16));
+
+    // close the gap between the lanes of each half, then store the two
+    // 6 byte runs. the second store runs 2 bytes past the block, the caller
+    // makes sure there is more output behind it.
+    n = _mm_or_si128(_mm_and_si128(n, _mm_set1_epi64x(0x00FFFFFF)),
+                     _mm_srli_epi64(_mm_andnot_si128(
+                                        _mm_set1_epi64x(0x00FFFFFF), n),
+                                    8));
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out), n);
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(out + 6),
+                     _mm_srli_si128(n, 8));
+    return true;
+}
+
+#elif defined(__ARM_NEON__)
+
+static constexpr size_t kB64Block = 64;
+
+static inline uint8x16_t b64decodeNeon(uint8x16_t c, uint8x16_t &valid)
+{
+    auto range = [&c](uint8_t lo, uint8_t hi) {
+        return vandq_u8(vcgeq_u8(c, vdupq_n_u8(lo)),
+                        vcleq_u8(c, vdupq_n_u8(hi)));
+    };
+    uint8x16_t upper = range('A', 'Z');
+    uint8x16_t lower = range('a', 'z');
+    uint8x16_t digit = range('0', '9');
+    uint8x16_t plus = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(c, vdupq_n_u8('/'));
+
+    valid = vandq_u8(valid, vorrq_u8(vorrq_u8(upper, lower),
+                                     vorrq_u8(digit, vorrq_u8(plus, slash))));
+
+    uint8x16_t offset = vorrq_u8(
+        vorrq_u8(vandq_u8(upper, vdupq_n_u8(uint8_t(-'A'))),
+                 vandq_u8(lower, vdupq_n_u8(uint8_t(26 - 'a')))),
+        vorrq_u8(vandq_u8(digit, vdupq_n_u8(uint8_t(52 - '0'))),
+                 vorrq_u8(vandq_u8(plus, vdupq_n_u8(uint8_t(62 - '+'))),
+                          vandq_u8(slash, vdupq_n_u8(uint8_t(63 - '/'))))));
+    return vaddq_u8(c, offset);
+}
+
+// 64 characters to 48 bytes, the loads deinterleave the quads
+static inline bool b64decodeBlock(const unsigned char *p, unsigned char *out)
+{
+    uint8x16x4_t c = vld4q_u8(p);
+    uint8x16_t   valid = vdupq_n_u8(0xFF);
+    uint8x16_t   a = b64decodeNeon(c.val[0], valid);
+    uint8x16_t   b = b64decodeNeon(c.val[1], valid);
+    uint8x16_t   d = b64decodeNeon(c.val[2], valid);
+    uint8x16_t   e = b64decodeNeon(c.val[3], valid);
+
+    uint64x2_t mask = vreinterpretq_u64_u8(valid);
+    if ((vgetq_lane_u64(mask, 0) & vgetq_lane_u64(mask, 1)) != ~uint64_t(0))
+        return false;
+
+    uint8x16x3_t result;
+    result.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    result.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d, 2));
+    result.val[2] = vorrq_u8(vshlq_n_u8(d, 6), e);
+    vst3q_u8(out, result);
+    return true;
+}
+
+#else
+
+static constexpr size_t kB64Block = 0;
+
+static inline bool b64decodeBlock(const unsigned char *, unsigned char *)
+{
+    return false;
+}
+
+#endif
+
+size_t model::base64DecodedSize(size_t len)
+{
+    return (len + 3) / 4 * 3;
+}
+
+// simd false decodes every quad through the table.
+static size_t b64decode(const char *data, const size_t len, unsigned char *out,
+                        bool simd)
+{
+    auto         p = reinterpret_cast<const unsigned char *>(data);
+    int          pad = len > 0 && (len % 4 || p[len - 1] == '=');
+    const size_t L = ((len + 3) / 4 - pad) * 4;
+    size_t       i = 0, j = 0;
+
+    // blocks may write a few bytes ahead, keep at least a quad behind them.
+    if (kB64Block && simd) {
+        while (i + kB64Block < L) {
+            if (b64decodeBlock(p + i, out + j)) {
+                i += kB64Block;
+                j += kB64Block / 4 * 3;
+            } else {
+                for (size_t end = i + kB64Block; i < end; i += 4, j += 3)
+                    b64decodeQuad(p + i, out + j);
+            }
+        }
+    }
+    for (; i < L; i += 4, j += 3) b64decodeQuad(p + i, out + j);
+
+    if (pad) {
+        int n = B64index[p[L]] << 18 | B64index[p[L + 1]] << 12;
+        out[j++] = n >> 16;
+
+        if (len > L + 2 && p[L + 2] != '=') {
+            n |= B64index[p[L + 2]] << 6;
+            out[j++] = n >> 8 & 0xFF;
+        }
+    }
+    return j;
+}
+
+size_t model::base64Decode(const char *data, size_t len, unsigned char *out)
+{
+    return b64decode(data, len, out, true);
+}
+
+size_t model::base64DecodeScalar(const char *data, size_t len,
+                                 unsigned char *out)
+{
+    return b64decode(data, len, out, false);
+}
+
+/*
+ * keeps the "data:[<mediatype>][;base64],<data>" url as it is, the base64
+ * payload is only decoded together with the image.
+ */
+void model::Asset::loadImageData(std::string url)
+{
+    size_t offset = url.find(',');
+    if (offset == std::string::npos) return;
+    mImageDataOffset = offset + 1;
+
+    // FNV-1a, the same embedded image in different files shares one entry.
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = mImageDataOffset; i < url.size(); i++) {
+        hash ^= static_cast<unsigned char>(url[i]);
+        hash *= 1099511628211ull;
+    }
+    char key[48];
+    snprintf(key, sizeof(key), "data:%016llx:%zu",
+             static_cast<unsigned long long>(hash),
+             url.size() - mImageDataOffset);
+    mImageKey = key;
+    mImageData = std::move(url);
 }
 
 void model::Asset::loadImagePath(std::string path)
 {
-    if (!path.empty()) mBitmap = VImageLoader::instance().load(path.c_str());
+    if (path.empty()) return;
+
+    mImageKey = path;
+    mImagePath = std::move(path);
+}
+
+VBitmap model::Asset::bitmap() const
+{
+    if (mImageKey.empty() || mImageFailed.load(std::memory_order_relaxed))
+        return {};
+
+    VBitmap result;
+    if (VImageCache::instance().find(mImageKey, result)) return result;
+
+    // decode outside of the cache lock, when two animations race on the
+    // same image the first one added wins and the other copy is dropped.
+    if (mImagePath.empty()) {
+        // decoded straight into the buffer handed to the image loader
+        size_t length = mImageData.size() - mImageDataOffset;
+        std::unique_ptr<unsigned char[]> data(
+            new unsigned char[base64DecodedSize(length)]);
+        length = base64Decode(mImageData.c_str() + mImageDataOffset, length,
+                              data.get());
+        result = VImageLoader::instance().load(
+            reinterpret_cast<const char *>(data.get()), length);
+    } else {
+        result = VImageLoader::instance().load(mImagePath.c_str());
+    }
+
+    if (!result.valid()) {
+        mImageFailed.store(true, std::memory_order_relaxed);
+        return {};
+    }
+
+    return VImageCache::instance().add(mImageKey, result);
+}
+
+/*
+ * decodes all the image assets up front, spread over the cores. The
+ * bitmaps land in the shared image cache where the image layers pick them
+ * up, so the cache budget has to hold them to be of any use.
+ */
+void model::Composition::decodeImages()
+{
+    std::vector<const Asset *> images;
+    for (const auto &asset : mAssets) {
+        if (!asset.second->mImageKey.empty()) images.push_back(asset.second);
+    }
+    if (images.empty()) return;
+
+    std::atomic<size_t> next{0};
+    auto                worker = [&]() {
+        for (size_t i = next++; i < images.size(); i = next++)
+            images[i]->bitmap();
+    };
+
+#ifdef LOTTIE_THREAD_SUPPORT
+    size_t count = std::min<size_t>(std::thread::hardware_concurrency(),
+                                    images.size());
+    std::vector<std::thread> threads;
+    for (size_t n = 1; n < count; n++) threads.emplace_back(worker);
+    worker();
+    for (auto &t : threads) t.join();
+#else
+    worker();
+#endif
 }
 
 std::vector<LayerInfo> model::Composition::layerInfoList() const
@@ -24,10 +24,13 @@
 #define LOTModel_H
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 #include "varenaalloc.h"
@@ -103,34 +106,42 @@ inline const Color operator*(float m, const Color &c)
     return Color(c.r * m, c.g * m, c.b * m);
 }
 
+/*
+ * the points are immutable once parsed. The parser hands out one shared
+ * copy for every identical path in the resource (repeated icons, hold
+ * keyframes, the end value of a keyframe being the start of the next),
+ * so copying a PathData only bumps a reference count.
+ */
 struct PathData {
-    std::vector<VPointF> mPoints;
-    bool                 mClosed = false; /* "c" */
-    void        reserve(size_t size) { mPoints.reserve(mPoints.size() + size); }
+    std::shared_ptr<const std::vector<VPointF>> mPoints;
+    bool                                        mClosed = false; /* "c" */
+
+    size_t         size() const { return mPoints ? mPoints->size() : 0; }
+    bool           empty() const { return size() == 0; }
+    const VPointF *points() const { return mPoints ? mPoints->data() : nullptr; }
+
     static void lerp(const PathData &start, const PathData &end, float t,
                      VPath &result)
     {
         result.reset();
         // test for empty animation data.
-        if (start.mPoints.empty() || end.mPoints.empty())
+        if (start.empty() || end.empty())
         {
             return;
         }
-        auto size = std::min(start.mPoints.size(), end.mPoints.size());
+        auto size = std::min(start.size(), end.size());
+        auto sp = start.points();
+        auto ep = end.points();
         /* reserve exact memory requirement at once
          * ptSize = size + 1(size + close)
          * elmSize = size/3 cubic + 1 move + 1 close
          */
         result.reserve(size + 1, size / 3 + 2);
-        result.moveTo(start.mPoints[0] +
-                      t * (end.mPoints[0] - start.mPoints[0]));
+        result.moveTo(sp[0] + t * (ep[0] - sp[0]));
         for (size_t i = 1; i < size; i += 3) {
-            result.cubicTo(
-                start.mPoints[i] + t * (end.mPoints[i] - start.mPoints[i]),
-                start.mPoints[i + 1] +
-                    t * (end.mPoints[i + 1] - start.mPoints[i + 1]),
-                start.mPoints[i + 2] +
-                    t * (end.mPoints[i + 2] - start.mPoints[i + 2]));
+            result.cubicTo(sp[i] + t * (ep[i] - sp[i]),
+                           sp[i + 1] + t * (ep[i + 1] - sp[i + 1]),
+                           sp[i + 2] + t * (ep[i + 2] - sp[i + 2]));
         }
         if (start.mClosed) result.close();
     }
@@ -138,10 +149,10 @@ struct PathData {
     {
         path.reset();
 
-        if (mPoints.empty()) return;
+        if (empty()) return;
 
-        auto size = mPoints.size();
-        auto points = mPoints.data();
+        auto size = this->size();
+        auto points = this->points();
         /* reserve exact memory requirement at once
          * ptSize = size + 1(size + close)
          * elmSize = size/3 cubic + 1 move + 1 close
@@ -215,18 +226,33 @@ struct Value<T, Position> {
     }
 };
 
+/*
+ * Animated values that can pre evaluate every integer frame of their
+ * range into a table (see Composition::bake()). bake() returns the
+ * memory used by the table, 0 if the value is not baked.
+ */
+class Bakeable {
+public:
+    virtual ~Bakeable() = default;
+    virtual size_t bake() = 0;
+
+protected:
+    // longer ranges keep evaluating the keyframes
+    static constexpr long maxBakedFrames = 1 << 16;
+};
+
 template <typename T, typename Tag>
-class KeyFrames {
+class KeyFrames : public Bakeable {
 public:
     struct Frame {
-        float progress(int frameNo) const
+        float progress(float frameNo) const
         {
             return interpolator_ ? interpolator_->value((frameNo - start_) /
                                                         (end_ - start_))
                                  : 0;
         }
-        T     value(int frameNo) const { return value_.at(progress(frameNo)); }
-        float angle(int frameNo) const
+        T     value(float frameNo) const { return value_.at(progress(frameNo)); }
+        float angle(float frameNo) const
         {
             return value_.angle(progress(frameNo));
         }
@@ -237,36 +263,84 @@ public:
         Value<T, Tag>  value_;
     };
 
-    T value(int frameNo) const
+    T value(float frameNo) const
     {
         if (!frames_.empty()) {
             if (frames_.front().start_ >= frameNo)
                 return frames_.front().value_.start_;
             if (frames_.back().end_ <= frameNo) return frames_.back().value_.end_;
 
-            for (const auto &keyFrame : frames_) {
-                if (frameNo >= keyFrame.start_ && frameNo < keyFrame.end_)
-                    return keyFrame.value(frameNo);
+            if (auto baked = baked_.load(std::memory_order_acquire)) {
+                auto index = long(frameNo) - baked->first;
+                if (float(long(frameNo)) == frameNo && index >= 0 &&
+                    size_t(index) < baked->values.size())
+                    return baked->values[size_t(index)];
             }
+
+            if (auto keyFrame = frameAt(frameNo))
+                return keyFrame->value(frameNo);
         }
         return {};
     }
 
-    float angle(int frameNo) const
+    float angle(float frameNo) const
     {
         if (frames_.empty() ||
             (frames_.front().start_ >= frameNo) ||
             (frames_.back().end_ <= frameNo))
             return 0;
 
-        for (const auto &frame : frames_) {
-            if (frameNo >= frame.start_ && frameNo < frame.end_)
-                return frame.angle(frameNo);
-        }
+        if (auto frame = frameAt(frameNo)) return frame->angle(frameNo);
         return 0;
     }
 
-    bool changed(int prevFrame, int curFrame) const
+    /*
+     * returns the first keyframe whose [start_, end_) contains frameNo.
+     * During playback the frame is almost always the one found last
+     * time or the one after it, so check those before falling back to
+     * a binary search on start_. The cursor is only a hint, a stale
+     * value from another thread just costs the search.
+     */
+    const Frame *frameAt(float frameNo) const
+    {
+        auto contains = [frameNo](const Frame &f) {
+            return frameNo >= f.start_ && frameNo < f.end_;
+        };
+
+        if (!sorted_) {
+            for (const auto &keyFrame : frames_)
+                if (contains(keyFrame)) return &keyFrame;
+            return nullptr;
+        }
+
+        size_t hint = cursor_.load(std::memory_order_relaxed);
+        if (hint < frames_.size()) {
+            if (contains(frames_[hint])) return &frames_[hint];
+            if (hint + 1 < frames_.size() && contains(frames_[hint + 1])) {
+                cursor_.store(hint + 1, std::memory_order_relaxed);
+                return &frames_[hint + 1];
+            }
+        }
+
+        // last frame starting at or before frameNo. keyframes are
+        // contiguous (end_ is the next start_) so that is the only
+        // candidate, scan linearly if the data says otherwise.
+        auto it = std::upper_bound(
+            frames_.begin(), frames_.end(), float(frameNo),
+            [](float v, const Frame &f) { return v < f.start_; });
+        if (it == frames_.begin()) return nullptr;
+        size_t index = size_t(std::distance(frames_.begin(), it)) - 1;
+        if (!contains(frames_[index])) {
+            for (const auto &keyFrame : frames_)
+                if (contains(keyFrame)) return &keyFrame;
+            return nullptr;
+        }
+
+        cursor_.store(index, std::memory_order_relaxed);
+        return &frames_[index];
+    }
+
+    bool changed(float prevFrame, float curFrame) const
     {
         if (frames_.empty()) return false;
 
@@ -279,10 +353,55 @@ public:
     void cache()
     {
         for (auto &e : frames_) e.value_.cache();
+        sorted_ = std::is_sorted(
+            frames_.begin(), frames_.end(),
+            [](const Frame &a, const Frame &b) { return a.start_ < b.start_; });
+    }
+
+    /*
+     * stores value() of every integer frame strictly inside the keyframe
+     * range, outside of it value() already returns the first/last value.
+     * Only plain values are baked, path and gradient data would cost a
+     * heap allocation per frame.
+     */
+    size_t bake() override
+    {
+        return bakeValues(std::is_trivially_copyable<T>{});
     }
 
+    ~KeyFrames() override { delete baked_.load(std::memory_order_relaxed); }
+
 public:
     std::vector<Frame> frames_;
+
+private:
+    struct Baked {
+        long           first;
+        std::vector<T> values;
+    };
+
+    size_t bakeValues(std::false_type) { return 0; }
+    size_t bakeValues(std::true_type)
+    {
+        if (frames_.empty() || baked_.load(std::memory_order_relaxed))
+            return 0;
+
+        long first = long(std::floor(frames_.front().start_)) + 1;
+        long last = long(std::ceil(frames_.back().end_)) - 1;
+        if (last < first || last - first >= maxBakedFrames) return 0;
+
+        auto baked = new Baked{first, {}};
+        baked->values.reserve(size_t(last - first + 1));
+        for (long frameNo = first; frameNo <= last; frameNo++)
+            baked->values.push_back(value(float(frameNo)));
+        baked_.store(baked, std::memory_order_release);
+
+        return sizeof(Baked) + baked->values.capacity() * sizeof(T);
+    }
+
+    bool                        sorted_{false};
+    mutable std::atomic<size_t> cursor_{0};
+    std::atomic<Baked *>        baked_{nullptr};
 };
 
 template <typename T, typename Tag = void>
@@ -331,14 +450,14 @@ public:
 
     bool isStatic() const { return isValue_; }
 
-    T value(int frameNo) const
+    T value(float frameNo) const
     {
         return isStatic() ? value() : animation().value(frameNo);
     }
 
     // special function only for type T=PathData
     template <typename forT = PathData>
-    auto value(int frameNo, VPath &path) const ->
+    auto value(float frameNo, VPath &path) const ->
         typename std::enable_if_t<std::is_same<T, forT>::value, void>
     {
         if (isStatic()) {
@@ -350,21 +469,19 @@ public:
             if (vec.back().end_ <= frameNo)
                 return vec.back().value_.end_.toPath(path);
 
-            for (const auto &keyFrame : vec) {
-                if (frameNo >= keyFrame.start_ && frameNo < keyFrame.end_) {
-                    T::lerp(keyFrame.value_.start_, keyFrame.value_.end_,
-                            keyFrame.progress(frameNo), path);
-                }
+            if (auto keyFrame = animation().frameAt(frameNo)) {
+                T::lerp(keyFrame->value_.start_, keyFrame->value_.end_,
+                        keyFrame->progress(frameNo), path);
             }
         }
     }
 
-    float angle(int frameNo) const
+    float angle(float frameNo) const
     {
         return isStatic() ? 0 : animation().angle(frameNo);
     }
 
-    bool changed(int prevFrame, int curFrame) const
+    bool changed(float prevFrame, float curFrame) const
     {
         return isStatic() ? false : animation().changed(prevFrame, curFrame);
     }
@@ -414,13 +531,13 @@ struct Dash {
             if (!elm.isStatic()) return false;
         return true;
     }
-    void getDashInfo(int frameNo, std::vector<float> &result) const;
+    void getDashInfo(float frameNo, std::vector<float> &result) const;
 };
 
 class Mask {
 public:
     enum class Mode { None, Add, Substarct, Intersect, Difference };
-    float opacity(int frameNo) const
+    float opacity(float frameNo) const
     {
         return mOpacity.value(frameNo) / 100.0f;
     }
@@ -508,19 +625,30 @@ private:
 
 struct Asset {
     enum class Type : unsigned char { Precomp, Image, Char };
+    // when the images are decoded, on first use or all of them in parallel
+    // right after parsing.
+    enum class ImageDecode { Lazy, Parallel };
+    static void        setImageDecode(ImageDecode mode);
+    static ImageDecode imageDecode();
+
     bool                  isStatic() const { return mStatic; }
     void                  setStatic(bool value) { mStatic = value; }
-    VBitmap               bitmap() const { return mBitmap; }
-    void                  loadImageData(std::string data);
+    VBitmap               bitmap() const;
+    void                  loadImageData(std::string url);
     void                  loadImagePath(std::string Path);
     Type                  mAssetType{Type::Precomp};
     bool                  mStatic{true};
     std::string           mRefId;  // ref id
     std::vector<Object *> mLayers;
-    // image asset data
-    int     mWidth{0};
-    int     mHeight{0};
-    VBitmap mBitmap;
+    // image asset data, decoded on first use through the shared image cache
+    int         mWidth{0};
+    int         mHeight{0};
+    std::string mImageKey;
+    std::string mImageData;  // data url of an embedded image
+    size_t      mImageDataOffset{0};  // start of the base64 payload
+    std::string mImagePath;
+    // set when decoding failed, the image is not tried again.
+    mutable std::atomic<bool> mImageFailed{false};
 };
 
 class Layer;
@@ -552,14 +680,31 @@ public:
     VSize  size() const { return mSize; }
     void   processRepeaterObjects();
     void   updateStats();
+    void   decodeImages();
+    size_t bake();
+    size_t bakedBytes() const { return mBakedBytes; }  // 0 until bake()
 
 public:
     struct Stats {
-        uint16_t precompLayerCount{0};
-        uint16_t solidLayerCount{0};
-        uint16_t shapeLayerCount{0};
-        uint16_t imageLayerCount{0};
-        uint16_t nullLayerCount{0};
+        uint32_t precompLayerCount{0};
+        uint32_t solidLayerCount{0};
+        uint32_t shapeLayerCount{0};
+        uint32_t imageLayerCount{0};
+        uint32_t nullLayerCount{0};
+        // render planning, filled by updateStats()
+        uint32_t staticLayerCount{0};    // layers whose subtree never changes
+        uint32_t hiddenLayerCount{0};    // never inside their parent's range
+        uint32_t matteLayerCount{0};     // layers drawn through a track matte
+        uint32_t maskLayerCount{0};
+        uint32_t offscreenLayerCount{0}; // may render to an offscreen surface
+        int      activeInFrame{0};       // frames outside [in, out] are empty
+        int      activeOutFrame{0};
+        uint32_t maxPathPoints{0};       // largest path payload, in points
+        // path payloads seen by the parser and how many distinct copies
+        // of them the model actually holds, see PathData.
+        uint32_t pathCount{0};
+        uint32_t uniquePathCount{0};
+        size_t   sharedPathBytes{0};
     };
 
 public:
@@ -575,11 +720,15 @@ public:
     std::vector<Marker> mMarkers;
     VArenaAlloc         mArenaAlloc{2048};
     Stats               mStats;
+    // animated values registered by the parser, see bake()
+    std::vector<Bakeable *> mBakeables;
+    std::once_flag          mBakeOnce;
+    size_t                  mBakedBytes{0};
 };
 
 class Transform : public Object {
 public:
-    struct Data {
+    struct Data : public Bakeable {
         struct Extra {
             Property<float> m3DRx{0};
             Property<float> m3DRy{0};
@@ -589,8 +738,8 @@ public:
             bool            mSeparate{false};
             bool            m3DData{false};
         };
-        VMatrix matrix(int frameNo, bool autoOrient = false) const;
-        float   opacity(int frameNo) const
+        VMatrix matrix(float frameNo, bool autoOrient = false) const;
+        float   opacity(float frameNo) const
         {
             return mOpacity.value(frameNo) / 100.0f;
         }
@@ -598,12 +747,31 @@ public:
         {
             if (!mExtra) mExtra = std::make_unique<Extra>();
         }
+        size_t bake() override;
+        ~Data() override { delete mBaked.load(std::memory_order_relaxed); }
         Property<float>             mRotation{0};       /* "r" */
         Property<VPointF>           mScale{{100, 100}}; /* "s" */
         Property<VPointF, Position> mPosition;          /* "p" */
         Property<VPointF>           mAnchor;            /* "a" */
         Property<float>             mOpacity{100};      /* "o" */
         std::unique_ptr<Extra>      mExtra;
+
+    private:
+        // one column per matrix element, plus the matrix types
+        struct Baked {
+            enum Column { M11, M12, M13, M21, M22, M23, MTX, MTY, M33, Count };
+            long                             first;
+            size_t                           frames;
+            std::vector<float>               columns;
+            std::vector<VMatrix::MatrixType> types;
+
+            float at(Column c, size_t index) const
+            {
+                return columns[c * frames + index];
+            }
+        };
+        VMatrix              computeMatrix(float frameNo, bool autoOrient) const;
+        std::atomic<Baked *> mBaked{nullptr};
     };
 
     Transform() : Object(Object::Type::Transform) {}
@@ -617,16 +785,22 @@ public:
             impl.mData = data;
         }
     }
-    VMatrix matrix(int frameNo, bool autoOrient = false) const
+    VMatrix matrix(float frameNo, bool autoOrient = false) const
     {
         if (isStatic()) return impl.mStaticData.mMatrix;
         return impl.mData->matrix(frameNo, autoOrient);
     }
-    float opacity(int frameNo) const
+    float opacity(float frameNo) const
     {
         if (isStatic()) return impl.mStaticData.mOpacity;
         return impl.mData->opacity(frameNo);
     }
+    // true if the opacity may be below 1 at some frame
+    bool translucent() const
+    {
+        if (isStatic()) return impl.mStaticData.mOpacity < 1.0f;
+        return !impl.mData->mOpacity.isStatic() || impl.mData->opacity(0) < 1.0f;
+    }
     Transform(const Transform &) = delete;
     Transform(Transform &&) = delete;
     Transform &operator=(Transform &) = delete;
@@ -697,15 +871,15 @@ public:
         return mExtra ? mExtra->mSolidColor : Color();
     }
     bool    autoOrient() const noexcept { return mAutoOrient; }
-    int     timeRemap(int frameNo) const;
+    float   timeRemap(float frameNo) const;
     VSize   layerSize() const { return mLayerSize; }
     bool    precompLayer() const { return mLayerType == Type::Precomp; }
-    VMatrix matrix(int frameNo) const
+    VMatrix matrix(float frameNo) const
     {
         return mTransform ? mTransform->matrix(frameNo, autoOrient())
                           : VMatrix{};
     }
-    float opacity(int frameNo) const
+    float opacity(float frameNo) const
     {
         return mTransform ? mTransform->opacity(frameNo) : 1.0f;
     }
@@ -753,7 +927,7 @@ public:
  * will be convert to frame number 30 if the frame rate is 60. or will result to
  * frame number 15 if the frame rate is 30.
  */
-inline int Layer::timeRemap(int frameNo) const
+inline float Layer::timeRemap(float frameNo) const
 {
     /*
      * only consider startFrame() when there is no timeRemap.
@@ -770,24 +944,27 @@ inline int Layer::timeRemap(int frameNo) const
      * slow down with respect to the overal animation. Time streach factor is
      * already applied to the layers inFrame and outFrame.
      * @TODO need to find out if timestreatch also affects the in and out frame
-     * of the child layers or not. */
-    return int(frameNo / mTimeStreatch);
+     * of the child layers or not.
+     * Stretched and remapped layers are kept on whole frames so sub frame
+     * rendering gives the same result as before on frame boundaries. */
+    if (mTimeStreatch == 1.0f) return frameNo;
+    return float(int(frameNo / mTimeStreatch));
 }
 
 class Stroke : public Object {
 public:
     Stroke() : Object(Object::Type::Stroke) {}
-    Color color(int frameNo) const { return mColor.value(frameNo); }
-    float opacity(int frameNo) const
+    Color color(float frameNo) const { return mColor.value(frameNo); }
+    float opacity(float frameNo) const
     {
         return mOpacity.value(frameNo) / 100.0f;
     }
-    float     strokeWidth(int frameNo) const { return mWidth.value(frameNo); }
+    float     strokeWidth(float frameNo) const { return mWidth.value(frameNo); }
     CapStyle  capStyle() const { return mCapStyle; }
     JoinStyle joinStyle() const { return mJoinStyle; }
     float     miterLimit() const { return mMiterLimit; }
     bool      hasDashInfo() const { return !mDash.empty(); }
-    void      getDashInfo(int frameNo, std::vector<float> &result) const
+    void      getDashInfo(float frameNo, std::vector<float> &result) const
     {
         return mDash.getDashInfo(frameNo, result);
     }
@@ -818,14 +995,14 @@ public:
         std::vector<float> mGradient;
     };
     explicit Gradient(Object::Type type) : Object(type) {}
-    inline float opacity(int frameNo) const
+    inline float opacity(float frameNo) const
     {
         return mOpacity.value(frameNo) / 100.0f;
     }
-    void update(std::unique_ptr<VGradient> &grad, int frameNo);
+    void update(std::unique_ptr<VGradient> &grad, float frameNo);
 
 private:
-    void populate(VGradientStops &stops, int frameNo);
+    void populate(VGradientStops &stops, float frameNo);
     float getOpacityAtPosition(float *opacities, size_t opacityArraySize, float position);
 
 public:
@@ -843,12 +1020,12 @@ public:
 class GradientStroke : public Gradient {
 public:
     GradientStroke() : Gradient(Object::Type::GStroke) {}
-    float     width(int frameNo) const { return mWidth.value(frameNo); }
+    float     width(float frameNo) const { return mWidth.value(frameNo); }
     CapStyle  capStyle() const { return mCapStyle; }
     JoinStyle joinStyle() const { return mJoinStyle; }
     float     miterLimit() const { return mMiterLimit; }
     bool      hasDashInfo() const { return !mDash.empty(); }
-    void      getDashInfo(int frameNo, std::vector<float> &result) const
+    void      getDashInfo(float frameNo, std::vector<float> &result) const
     {
         return mDash.getDashInfo(frameNo, result);
     }
@@ -873,8 +1050,8 @@ public:
 class Fill : public Object {
 public:
     Fill() : Object(Object::Type::Fill) {}
-    Color color(int frameNo) const { return mColor.value(frameNo); }
-    float opacity(int frameNo) const
+    Color color(float frameNo) const { return mColor.value(frameNo); }
+    float opacity(float frameNo) const
     {
         return mOpacity.value(frameNo) / 100.0f;
     }
@@ -910,7 +1087,7 @@ public:
 class RoundedCorner : public Object {
 public:
     RoundedCorner() : Object(Object::Type::RoundedCorner) {}
-    float radius(int frameNo) const { return mRadius.value(frameNo);}
+    float radius(float frameNo) const { return mRadius.value(frameNo);}
 public:
     Property<float>   mRadius{0};
 };
@@ -918,13 +1095,13 @@ public:
 class Rect : public Shape {
 public:
     Rect() : Shape(Object::Type::Rect) {}
-    float roundness(int frameNo)
+    float roundness(float frameNo)
     {
         return mRoundedCorner ? mRoundedCorner->radius(frameNo) :
                                 mRound.value(frameNo);
     }
 
-    bool roundnessChanged(int prevFrame, int curFrame)
+    bool roundnessChanged(float prevFrame, float curFrame)
     {
         return mRoundedCorner ? mRoundedCorner->mRadius.changed(prevFrame, curFrame) :
                         mRound.changed(prevFrame, curFrame);
@@ -964,12 +1141,12 @@ public:
 class Repeater : public Object {
 public:
     struct Transform {
-        VMatrix matrix(int frameNo, float multiplier) const;
-        float   startOpacity(int frameNo) const
+        VMatrix matrix(float frameNo, float multiplier) const;
+        float   startOpacity(float frameNo) const
         {
             return mStartOpacity.value(frameNo) / 100;
         }
-        float endOpacity(int frameNo) const
+        float endOpacity(float frameNo) const
         {
             return mEndOpacity.value(frameNo) / 100;
         }
@@ -990,8 +1167,8 @@ public:
     Group *content() const { return mContent ? mContent : nullptr; }
     void   setContent(Group *content) { mContent = content; }
     int    maxCopies() const { return int(mMaxCopies); }
-    float  copies(int frameNo) const { return mCopies.value(frameNo); }
-    float  offset(int frameNo) const { return mOffset.value(frameNo); }
+    float  copies(float frameNo) const { return mCopies.value(frameNo); }
+    float  offset(float frameNo) const { return mOffset.value(frameNo); }
     bool   processed() const { return mProcessed; }
     void   markProcessed() { mProcessed = true; }
 
@@ -1002,6 +1179,7 @@ public:
     Property<float> mOffset{0};
     float           mMaxCopies{0.0};
     bool            mProcessed{false};
+    bool            mTrimmed{false};  // the layer has path operators
 };
 
 class Trim : public Object {
@@ -1033,7 +1211,7 @@ public:
      * if start < end vector trims the path without loop ( 1 segment).
      * if no offset then there is no loop.
      */
-    Segment segment(int frameNo) const
+    Segment segment(float frameNo) const
     {
         float start = mStart.value(frameNo) / 100.0f;
         float end = mEnd.value(frameNo) / 100.0f;
@@ -1159,6 +1337,32 @@ std::shared_ptr<model::Composition> loadFromData(std::string jsonData,
 std::shared_ptr<model::Composition> parse(char *str, size_t length, std::string dir_path,
                                           ColorFilter filter = {});
 
+/*
+ * base64 payload of the embedded images, out needs base64DecodedSize()
+ * bytes and the exact decoded size is returned. base64Decode() takes the
+ * simd blocks when the cpu has them, base64DecodeScalar() is the table
+ * decoder it has to match byte for byte.
+ */
+size_t base64DecodedSize(size_t len);
+size_t base64Decode(const char *data, size_t len, unsigned char *out);
+size_t base64DecodeScalar(const char *data, size_t len, unsigned char *out);
+
+/*
+ * builds the model while the json text is still arriving, feed() the data
+ * as it comes and finish() waits for the parse of the remaining part.
+ */
+class StreamParser {
+public:
+    explicit StreamParser(std::string dir_path, ColorFilter filter = {});
+    ~StreamParser();
+    void                         feed(const char *data, size_t size);
+    std::shared_ptr<Composition> finish();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> mImpl;
+};
+
 }  // namespace model
 
 }  // namespace internal
@@ -51,10 +51,14 @@
 // returned null), you should not call SkipArray().
 //
 // This parser uses in-situ strings, so the JSON buffer will be altered during
-// the parse.
+// the parse. When the JSON arrives in pieces (see model::StreamParser) the
+// tokens are read from a ChunkStream instead and the strings are copied.
 
 #include <array>
+#include <condition_variable>
+#include <deque>
 
+#include "config.h"
 #include "lottiemodel.h"
 #include "rapidjson/document.h"
 #include "zip/zip.h"
@@ -74,10 +78,81 @@ RAPIDJSON_DIAG_OFF(effc++)
 #define PATH_MAX MAX_PATH
 #endif
 
+#ifdef LOTTIE_THREAD_SUPPORT
+#include <thread>
+#endif
+
 using namespace rapidjson;
 
 using namespace rlottie::internal;
 
+/*
+ * rapidjson input stream over the chunks handed to feed(), the reader
+ * waits in Peek() for the next chunk until finish() is called.
+ */
+class ChunkStream {
+public:
+    typedef char Ch;
+
+    Ch     Peek() { return mCur != mEnd ? *mCur : next(); }
+    Ch     Take()
+    {
+        Ch c = Peek();
+        if (mCur != mEnd) ++mCur;
+        return c;
+    }
+    size_t Tell() const { return mOffset + size_t(mCur - mBegin); }
+
+    // only used by the insitu parsing.
+    Ch *   PutBegin() { RAPIDJSON_ASSERT(false); return nullptr; }
+    void   Put(Ch) { RAPIDJSON_ASSERT(false); }
+    void   Flush() { RAPIDJSON_ASSERT(false); }
+    size_t PutEnd(Ch *) { RAPIDJSON_ASSERT(false); return 0; }
+
+    void feed(std::string chunk)
+    {
+        if (chunk.empty()) return;
+
+        std::lock_guard<std::mutex> guard(mMutex);
+        mChunks.push_back(std::move(chunk));
+        mCond.notify_one();
+    }
+    void finish()
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mDone = true;
+        mCond.notify_one();
+    }
+
+private:
+    Ch next()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this] { return !mChunks.empty() || mDone; });
+
+        mOffset += size_t(mEnd - mBegin);
+        if (mChunks.empty()) {
+            mBegin = mCur = mEnd = nullptr;
+            return '\0';
+        }
+        mCurrent = std::move(mChunks.front());
+        mChunks.pop_front();
+        mBegin = mCur = mCurrent.data();
+        mEnd = mBegin + mCurrent.size();
+        return *mCur;
+    }
+
+    const Ch *              mBegin{nullptr};
+    const Ch *              mCur{nullptr};
+    const Ch *              mEnd{nullptr};
+    size_t                  mOffset{0};
+    std::string             mCurrent;
+    std::deque<std::string> mChunks;
+    std::mutex              mMutex;
+    std::condition_variable mCond;
+    bool                    mDone{false};
+};
+
 class LookaheadParserHandler {
 public:
     bool Null()
@@ -123,10 +198,10 @@ public:
         return true;
     }
     bool RawNumber(const char *, SizeType, bool) { return false; }
-    bool String(const char *str, SizeType length, bool)
+    bool String(const char *str, SizeType length, bool copy)
     {
         st_ = kHasString;
-        v_.SetString(str, length);
+        v_.SetString(copy ? keep(str, length) : str, length);
         return true;
     }
     bool StartObject()
@@ -134,10 +209,10 @@ public:
         st_ = kEnteringObject;
         return true;
     }
-    bool Key(const char *str, SizeType length, bool)
+    bool Key(const char *str, SizeType length, bool copy)
     {
         st_ = kHasKey;
-        v_.SetString(str, length);
+        v_.SetString(copy ? keep(str, length) : str, length);
         return true;
     }
     bool EndObject(SizeType)
@@ -162,6 +237,27 @@ public:
     }
 protected:
     explicit LookaheadParserHandler(char *str);
+    explicit LookaheadParserHandler(ChunkStream *stream);
+
+    /*
+     * the reader only lends the strings it copies out of a ChunkStream,
+     * keep them until the end of the parse like the insitu ones.
+     */
+    const char *keep(const char *str, SizeType length)
+    {
+        if (length + 1 > mStringSpace) {
+            size_t size = std::max<size_t>(length + 1, 64 * 1024);
+            mStringBlocks.emplace_back(new char[size]);
+            mStringNext = mStringBlocks.back().get();
+            mStringSpace = size;
+        }
+        char *result = mStringNext;
+        memcpy(result, str, length);
+        result[length] = '\0';
+        mStringNext += length + 1;
+        mStringSpace -= length + 1;
+        return result;
+    }
 
 protected:
     enum LookaheadParsingState {
@@ -182,8 +278,14 @@ protected:
     LookaheadParsingState st_;
     Reader                r_;
     InsituStringStream    ss_;
+    ChunkStream *         cs_{nullptr};
+
+    std::vector<std::unique_ptr<char[]>> mStringBlocks;
+    char *                               mStringNext{nullptr};
+    size_t                               mStringSpace{0};
 
     static const int parseFlags = kParseDefaultFlags | kParseInsituFlag;
+    static const int streamFlags = kParseDefaultFlags;
 };
 
 class LottieParserImpl : public LookaheadParserHandler {
@@ -194,6 +296,13 @@ public:
           mDirPath(std::move(dir_path))
     {
     }
+    LottieParserImpl(ChunkStream *stream, std::string dir_path,
+                     model::ColorFilter filter)
+        : LookaheadParserHandler(stream),
+          mColorFilter(std::move(filter)),
+          mDirPath(std::move(dir_path))
+    {
+    }
     bool VerifyType();
     bool ParseNext();
 
@@ -268,6 +377,8 @@ public:
     void getValue(model::Color &color);
     void getValue(int &ival);
     void getValue(model::PathData &shape);
+    std::shared_ptr<const std::vector<VPointF>> intern(
+        const std::vector<VPointF> &points);
     void getValue(model::Gradient::Data &gradient);
     void getValue(std::vector<VPointF> &v);
     void getValue(model::Repeater::Transform &);
@@ -291,7 +402,7 @@ public:
     void parseShapeProperty(model::Property<model::PathData> &obj);
     void parseDashProperty(model::Dash &dash);
 
-    VInterpolator *interpolator(VPointF, VPointF, std::string);
+    VInterpolator *interpolator(VPointF, VPointF);
 
     model::Color toColor(const char *str);
 
@@ -375,6 +486,10 @@ private:
 
 protected:
     std::unordered_map<std::string, VInterpolator *> mInterpolatorCache;
+    // parsed path payloads by content hash, see intern()
+    std::unordered_map<
+        size_t, std::vector<std::shared_ptr<const std::vector<VPointF>>>>
+        mPathPool;
     std::shared_ptr<model::Composition>              mComposition;
     model::Composition *                             compRef{nullptr};
     model::Layer *                                   curLayerRef{nullptr};
@@ -389,6 +504,12 @@ LookaheadParserHandler::LookaheadParserHandler(char *str)
     r_.IterativeParseInit();
 }
 
+LookaheadParserHandler::LookaheadParserHandler(ChunkStream *stream)
+    : v_(), st_(kInit), ss_(nullptr), cs_(stream)
+{
+    r_.IterativeParseInit();
+}
+
 bool LottieParserImpl::VerifyType()
 {
     /* Verify the media type is lottie json.
@@ -403,7 +524,9 @@ bool LottieParserImpl::ParseNext()
         return false;
     }
 
-    if (!r_.IterativeParseNext<parseFlags>(ss_, *this)) {
+    bool result = cs_ ? r_.IterativeParseNext<streamFlags>(*cs_, *this)
+                      : r_.IterativeParseNext<parseFlags>(ss_, *this);
+    if (!result) {
         vCritical << "Lottie file parsing error";
         st_ = kError;
         return false;
@@ -759,54 +882,6 @@ void LottieParserImpl::parseAssets(model::Composition *composition)
     // update the precomp layers with the actual layer object
 }
 
-static constexpr const unsigned char B64index[256] = {
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  62, 63, 62, 62, 63, 52, 53, 54, 55, 56, 57,
-    58, 59, 60, 61, 0,  0,  0,  0,  0,  0,  0,  0,  1,  2,  3,  4,  5,  6,
-    7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
-    25, 0,  0,  0,  0,  63, 0,  26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
-    37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
-
-std::string b64decode(const char *data, const size_t len)
-{
-    auto         p = reinterpret_cast<const unsigned char *>(data);
-    int          pad = len > 0 && (len % 4 || p[len - 1] == '=');
-    const size_t L = ((len + 3) / 4 - pad) * 4;
-    std::string  str(L / 4 * 3 + pad, '\0');
-
-    for (size_t i = 0, j = 0; i < L; i += 4) {
-        int n = B64index[p[i]] << 18 | B64index[p[i + 1]] << 12 |
-                B64index[p[i + 2]] << 6 | B64index[p[i + 3]];
-        str[j++] = n >> 16;
-        str[j++] = n >> 8 & 0xFF;
-        str[j++] = n & 0xFF;
-    }
-    if (pad) {
-        int n = B64index[p[L]] << 18 | B64index[p[L + 1]] << 12;
-        str[str.size() - 1] = n >> 16;
-
-        if (len > L + 2 && p[L + 2] != '=') {
-            n |= B64index[p[L + 2]] << 6;
-            str.push_back(n >> 8 & 0xFF);
-        }
-    }
-    return str;
-}
-
-static std::string convertFromBase64(const std::string &str)
-{
-    // usual header look like "data:image/png;base64,"
-    // so need to skip till ','.
-    size_t startIndex = str.find(",", 0);
-    startIndex += 1;  // skip ","
-    size_t length = str.length() - startIndex;
-
-    const char *b64Data = str.c_str() + startIndex;
-
-    return b64decode(b64Data, length);
-}
-
 namespace
 {
    #ifdef _WIN32
@@ -970,7 +1045,7 @@ model::Asset *LottieParserImpl::parseAsset()
             // embedded resource should start with "data:"
             // URL Scheme: "data:[<mediatype>][;base64],<data>"
             if (filename.compare(0, 5, "data:") == 0 && filename.find(',') != std::string::npos) {
-                asset->loadImageData(convertFromBase64(filename));
+                asset->loadImageData(std::move(filename));
             }
         } else {
             // reject dangerous paths
@@ -1703,6 +1778,7 @@ model::Transform *LottieParserImpl::parseTransformObject(bool ddd)
     }
 
     objT->set(obj, isStatic);
+    if (!isStatic) compRef->mBakeables.push_back(obj);
 
     return objT;
 }
@@ -2057,10 +2133,43 @@ void LottieParserImpl::parsePathInfo()
 void LottieParserImpl::getValue(model::PathData &obj)
 {
     parsePathInfo();
-    obj.mPoints = mPathInfo.mResult;
+    obj.mPoints = intern(mPathInfo.mResult);
     obj.mClosed = mPathInfo.mClosed;
 }
 
+/*
+ * returns the shared copy of a path payload, creating it on first
+ * sight. Lookup is by a hash of the raw point data, candidates are
+ * compared bytewise so the model renders exactly what was parsed.
+ */
+std::shared_ptr<const std::vector<VPointF>> LottieParserImpl::intern(
+    const std::vector<VPointF> &points)
+{
+    size_t bytes = points.size() * sizeof(VPointF);
+    auto   data = reinterpret_cast<const unsigned char *>(points.data());
+
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < bytes; i++) hash = (hash ^ data[i]) * 16777619u;
+
+    auto &stats = compRef->mStats;
+    stats.pathCount++;
+    stats.maxPathPoints =
+        std::max(stats.maxPathPoints, uint32_t(points.size()));
+
+    auto &bucket = mPathPool[hash];
+    for (const auto &candidate : bucket) {
+        if (candidate->size() == points.size() &&
+            (!bytes || !memcmp(candidate->data(), data, bytes))) {
+            stats.sharedPathBytes += bytes;
+            return candidate;
+        }
+    }
+
+    stats.uniquePathCount++;
+    bucket.push_back(std::make_shared<const std::vector<VPointF>>(points));
+    return bucket.back();
+}
+
 VPointF LottieParserImpl::parseInperpolatorPoint()
 {
     VPointF cp;
@@ -2092,16 +2201,18 @@ bool LottieParserImpl::parseKeyFrameValue(
     return true;
 }
 
-VInterpolator *LottieParserImpl::interpolator(VPointF     inTangent,
-                                              VPointF     outTangent,
-                                              std::string key)
+/*
+ * interpolators are shared by every keyframe using the same easing
+ * curve. Key on the exact tangent values, the "n" name exported by AE
+ * is rounded and not guaranteed to match the curve.
+ */
+VInterpolator *LottieParserImpl::interpolator(VPointF inTangent,
+                                              VPointF outTangent)
 {
-    if (key.empty()) {
-        std::array<char, 20> temp;
-        snprintf(temp.data(), temp.size(), "%.2f_%.2f_%.2f_%.2f", inTangent.x(),
-                 inTangent.y(), outTangent.x(), outTangent.y());
-        key = temp.data();
-    }
+    std::array<float, 4> tangents{
+        {inTangent.x(), inTangent.y(), outTangent.x(), outTangent.y()}};
+    std::string key(reinterpret_cast<const char *>(tangents.data()),
+                    sizeof(tangents));
 
     auto search = mInterpolatorCache.find(key);
 
@@ -2121,11 +2232,10 @@ template <typename T, typename Tag>
 void LottieParserImpl::parseKeyFrame(model::KeyFrames<T, Tag> &obj)
 {
     struct ParsedField {
-        std::string interpolatorKey;
-        bool        interpolator{false};
-        bool        value{false};
-        bool        hold{false};
-        bool        noEndValue{true};
+        bool interpolator{false};
+        bool value{false};
+        bool hold{false};
+        bool noEndValue{true};
     };
 
     EnterObject();
@@ -2150,21 +2260,6 @@ void LottieParserImpl::parseKeyFrame(model::KeyFrames<T, Tag> &obj)
             parsed.noEndValue = false;
             getValue(keyframe.value_.end_);
             continue;
-        } else if (0 == strcmp(key, "n")) {
-            if (PeekType() == kStringType) {
-                parsed.interpolatorKey = GetStringObject();
-            } else {
-                EnterArray();
-                while (NextArrayValue()) {
-                    if (parsed.interpolatorKey.empty()) {
-                        parsed.interpolatorKey = GetStringObject();
-                    } else {
-                        // skip rest of the string
-                        Skip(nullptr);
-                    }
-                }
-            }
-            continue;
         } else if (parseKeyFrameValue(key, keyframe.value_)) {
             continue;
         } else if (0 == strcmp(key, "h")) {
@@ -2193,8 +2288,7 @@ void LottieParserImpl::parseKeyFrame(model::KeyFrames<T, Tag> &obj)
         keyframe.end_ = keyframe.start_;
         list.push_back(std::move(keyframe));
     } else if (parsed.interpolator) {
-        keyframe.interpolator_ = interpolator(
-            inTangent, outTangent, std::move(parsed.interpolatorKey));
+        keyframe.interpolator_ = interpolator(inTangent, outTangent);
         list.push_back(std::move(keyframe));
     } else {
         // its the last frame discard.
@@ -2269,6 +2363,7 @@ void LottieParserImpl::parsePropertyHelper(model::Property<T, Tag> &obj)
             }
         }
         obj.cache();
+        if (!obj.isStatic()) compRef->mBakeables.push_back(&obj.animation());
     }
 }
 
@@ -2521,12 +2616,8 @@ static bool checkDotLottie(const char * str)
     else return false;
 }
 
-std::shared_ptr<model::Composition> parseImpl(char* input,
-                                              std::string dir_path,
-                                              model::ColorFilter filter)
+static std::shared_ptr<model::Composition> parseImpl(LottieParserImpl &obj)
 {
-    LottieParserImpl obj(input, std::move(dir_path), std::move(filter));
-
     if (!obj.VerifyType()) {
         vWarning << "Input data is not Lottie format!";
         return {};
@@ -2537,6 +2628,8 @@ std::shared_ptr<model::Composition> parseImpl(char* input,
     if (composition) {
         composition->processRepeaterObjects();
         composition->updateStats();
+        if (model::Asset::imageDecode() == model::Asset::ImageDecode::Parallel)
+            composition->decodeImages();
 
 #ifdef LOTTIE_DUMP_TREE_SUPPORT
         ObjectInspector inspector;
@@ -2547,6 +2640,14 @@ std::shared_ptr<model::Composition> parseImpl(char* input,
     return composition;
 }
 
+std::shared_ptr<model::Composition> parseImpl(char* input,
+                                              std::string dir_path,
+                                              model::ColorFilter filter)
+{
+    LottieParserImpl obj(input, std::move(dir_path), std::move(filter));
+    return parseImpl(obj);
+}
+
 std::shared_ptr<model::Composition> model::parse(char *             str,
                                                  size_t             length,
                                                  std::string        dir_path,
@@ -2569,4 +2670,93 @@ std::shared_ptr<model::Composition> model::parse(char *             str,
     return result;
 }
 
+/*
+ * The first bytes are kept back until the format is known. A .lottie
+ * archive (or a build without threads) is collected and parsed by
+ * finish(), json text is parsed on a worker thread while it arrives.
+ */
+struct model::StreamParser::Impl {
+    Impl(std::string dir_path, model::ColorFilter filter)
+        : mDirPath(std::move(dir_path)), mFilter(std::move(filter))
+    {
+    }
+    ~Impl()
+    {
+#ifdef LOTTIE_THREAD_SUPPORT
+        if (mWorker.joinable()) {
+            mStream.finish();
+            mWorker.join();
+        }
+#endif
+    }
+
+    void feed(const char *data, size_t size)
+    {
+#ifdef LOTTIE_THREAD_SUPPORT
+        if (mWorker.joinable()) {
+            mStream.feed(std::string(data, size));
+            return;
+        }
+#endif
+        mBuffer.append(data, size);
+
+#ifdef LOTTIE_THREAD_SUPPORT
+        if (mArchive || mBuffer.size() < 4) return;
+
+        if (checkDotLottie(mBuffer.c_str())) {
+            mArchive = true;
+            return;
+        }
+
+        mStream.feed(std::move(mBuffer));
+        mWorker = std::thread([this]() {
+            LottieParserImpl obj(&mStream, mDirPath, mFilter);
+            mResult = parseImpl(obj);
+        });
+#endif
+    }
+
+    std::shared_ptr<model::Composition> finish()
+    {
+#ifdef LOTTIE_THREAD_SUPPORT
+        if (mWorker.joinable()) {
+            mStream.finish();
+            mWorker.join();
+            return std::move(mResult);
+        }
+#endif
+        if (mBuffer.empty()) return {};
+
+        return model::parse(&mBuffer[0], mBuffer.size(), std::move(mDirPath),
+                            std::move(mFilter));
+    }
+
+    std::string                         mDirPath;
+    model::ColorFilter                  mFilter;
+    std::string                         mBuffer;
+    bool                                mArchive{false};
+    ChunkStream                         mStream;
+    std::shared_ptr<model::Composition> mResult;
+#ifdef LOTTIE_THREAD_SUPPORT
+    std::thread mWorker;
+#endif
+};
+
+model::StreamParser::StreamParser(std::string dir_path, ColorFilter filter)
+    : mImpl(std::make_unique<Impl>(std::move(dir_path), std::move(filter)))
+{
+}
+
+model::StreamParser::~StreamParser() = default;
+
+void model::StreamParser::feed(const char *data, size_t size)
+{
+    if (data && size) mImpl->feed(data, size);
+}
+
+std::shared_ptr<model::Composition> model::StreamParser::finish()
+{
+    return mImpl->finish();
+}
+
 RAPIDJSON_DIAG_POP
@@ -42,6 +42,7 @@
 #endif
 
 class AnimationImpl;
+class AnimationLoaderImpl;
 struct LOTNode;
 struct LOTLayerNode;
 
@@ -64,6 +65,209 @@ namespace rlottie {
  */
 RLOTTIE_API void configureModelCacheSize(size_t cacheSize);
 
+/**
+ *  @brief Configures the decoded image cache.
+ *
+ *  Image assets are decoded the first time they are drawn and the pixels
+ *  are shared by all the animations using the same image. Least recently
+ *  used images are dropped once the decoded pixels exceed the budget.
+ *
+ *  @param[in] bytes  Budget of the decoded pixels, 0 disables the cache.
+ *
+ *  @note default budget is 64MB.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureImageCacheSize(size_t bytes);
+
+/**
+ *  @brief Drops all the decoded images held by the image cache.
+ *
+ *  Meant to be called on memory pressure. Images drawn by a live animation
+ *  are released when the animation is destroyed, the others are decoded
+ *  again on their next use.
+ *
+ *  @internal
+ */
+RLOTTIE_API void purgeImageCache();
+
+/**
+ *  @brief Rasterizer used to generate the coverage of the shapes.
+ */
+enum class RasterBackend {
+    Gray,         /* freetype gray raster */
+    Accumulation  /* signed area accumulation raster */
+};
+
+/**
+ *  @brief Configures the rasterizer backend used by the library.
+ *
+ *  Library level setting, takes effect for all the paths rasterized
+ *  after the call.
+ *
+ *  @param[in] backend  Rasterizer backend.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureRasterBackend(RasterBackend backend);
+
+/**
+ *  @brief Returns the rasterizer backend in use.
+ *
+ *  @internal
+ */
+RLOTTIE_API RasterBackend rasterBackend();
+
+/**
+ *  @brief How keyframe easing curves are evaluated.
+ */
+enum class EasingMode {
+    Exact,  /* solve the bezier curve on every evaluation */
+    Table   /* 256 entry lookup table built at load time */
+};
+
+/**
+ *  @brief Configures how easing curves are evaluated.
+ *
+ *  Library level setting, the tables are built while parsing so it only
+ *  affects animations loaded after the call. Animations already in the
+ *  model cache keep the mode they were loaded with.
+ *
+ *  @param[in] mode  Easing evaluation mode.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureEasing(EasingMode mode);
+
+/**
+ *  @brief Returns the easing evaluation mode used for new animations.
+ *
+ *  @internal
+ */
+RLOTTIE_API EasingMode easingMode();
+
+/**
+ *  @brief When the image assets are decoded.
+ */
+enum class ImageDecode {
+    Lazy,     /* the first time the image is drawn */
+    Parallel  /* all of them right after parsing, spread over the cores */
+};
+
+/**
+ *  @brief Configures when the image assets are decoded.
+ *
+ *  Library level setting, only affects animations loaded after the call.
+ *  Decoded images are kept in the image cache, @see configureImageCacheSize()
+ *
+ *  @param[in] mode  Image decoding mode.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureImageDecode(ImageDecode mode);
+
+/**
+ *  @brief Counters of the offscreen surface pool.
+ */
+struct SurfaceCacheStats {
+    size_t allocations{0};    /* surfaces that needed a new buffer */
+    size_t reuses{0};         /* surfaces served from the pool */
+    size_t retainedBytes{0};  /* free buffers kept for reuse */
+    size_t peakBytes{0};      /* most surface memory, in use and free */
+};
+
+/**
+ *  @brief Configures the offscreen surface pool.
+ *
+ *  Mattes, masks and translucent precompositions are drawn into offscreen
+ *  surfaces. Released surfaces are kept by size class and reused by the
+ *  next frame or by other animations, up to the budget.
+ *
+ *  @param[in] bytes  Budget of the free surfaces, 0 disables the reuse.
+ *
+ *  @note default budget is 32MB.
+ *
+ *  @internal
+ */
+RLOTTIE_API void configureSurfaceCacheSize(size_t bytes);
+
+/**
+ *  @brief Drops all the free surfaces held by the surface pool.
+ *
+ *  Meant to be called on memory pressure, surfaces in use by a render
+ *  are not affected.
+ *
+ *  @internal
+ */
+RLOTTIE_API void purgeSurfaceCache();
+
+/**
+ *  @brief Returns the counters of the surface pool.
+ *
+ *  @internal
+ */
+RLOTTIE_API SurfaceCacheStats surfaceCacheStats();
+
+/**
+ *  @brief Tolerance used when flattening curves into lines.
+ */
+enum class RenderQuality {
+    Auto,    /* same as Normal */
+    High,    /* quarter pixel */
+    Normal,  /* half pixel */
+    Fast     /* one pixel */
+};
+
+/**
+ *  @brief Sampling of image layers that are scaled or rotated.
+ */
+enum class ImageFilter {
+    Nearest,   /* closest texel, fastest */
+    Bilinear   /* weighted between the four closest texels */
+};
+
+/**
+ *  @brief Summary of the content of a Lottie resource, meant for
+ *  predicting how expensive it is to render.
+ *
+ *  Layers that are never inside the frame range of their composition
+ *  are only counted in hiddenLayerCount. Layers of a precomposition
+ *  used several times are counted once per use.
+ */
+struct AnimationStats {
+    size_t layerCount{0};          /* drawn layers, nested ones included */
+    size_t shapeLayerCount{0};
+    size_t precompLayerCount{0};
+    size_t imageLayerCount{0};
+    size_t solidLayerCount{0};
+    size_t staticLayerCount{0};    /* layers whose content never changes */
+    size_t hiddenLayerCount{0};    /* layers that are never drawn */
+    size_t matteLayerCount{0};     /* layers drawn through a track matte */
+    size_t maskLayerCount{0};      /* layers with masks */
+    size_t offscreenLayerCount{0}; /* layers that may need an offscreen surface */
+    size_t maxPathPoints{0};       /* points in the largest path */
+    size_t pathCount{0};           /* path data in the resource */
+    size_t uniquePathCount{0};     /* distinct path data kept in memory */
+    size_t sharedPathBytes{0};     /* path point data shared, not copied */
+    size_t activeInFrame{0};       /* first frame with visible content */
+    size_t activeOutFrame{0};      /* last frame with visible content */
+    bool   hasContent{false};      /* false if no frame draws anything */
+    bool   isStatic{false};        /* every frame renders the same */
+};
+
+/**
+ *  @brief Counters of the last rendered frame.
+ *
+ *  Layers are counted once per use, nested ones included. A culled layer
+ *  is visible in the frame but entirely beneath an opaque layer, it is
+ *  not blended. Without the raster task scheduler it is not rasterized
+ *  either.
+ */
+struct RenderStats {
+    size_t drawnLayerCount{0};   /* visible layers that were drawn */
+    size_t culledLayerCount{0};  /* visible layers hidden by opaque ones */
+};
+
 struct Color {
     Color() = default;
     Color(float r, float g , float b):_r(r), _g(g), _b(b){}
@@ -423,6 +627,88 @@ public:
      */
     void              renderSync(size_t frameNo, Surface surface, bool keepAspectRatio=true);
 
+    /**
+     *  @brief Renders the content at time @p timeInSec synchronously.
+     *
+     *  Unlike renderSync() the time is not rounded to a frame, keyframes
+     *  are interpolated in between two frames so content can be drawn at
+     *  a higher rate than the animation frame rate. Layers using time
+     *  remapping or time stretch still advance on whole frames.
+     *
+     *  @param[in] timeInSec Time from the start of the animation in seconds,
+     *                       clamped to the animation duration.
+     *  @param[in] surface Surface in which content will be drawn
+     *  @param[in] keepAspectRatio whether to keep the aspect ratio while scaling the content.
+     *
+     *  @internal
+     */
+    void              renderSyncAtTime(double timeInSec, Surface surface, bool keepAspectRatio=true);
+
+    /**
+     *  @brief Sets the curve flattening tolerance used when rendering.
+     *
+     *  The tolerance is in surface pixels, curves are flattened after the
+     *  content is scaled to the surface. RenderQuality::Auto (the default)
+     *  is the same as RenderQuality::Normal.
+     *
+     *  @param[in] quality Flattening quality.
+     *
+     *  @internal
+     */
+    void              setRenderQuality(RenderQuality quality);
+
+    /**
+     *  @brief Sets how image layers are sampled when they are scaled or
+     *  rotated.
+     *
+     *  ImageFilter::Nearest (the default) is the cheapest and fits small
+     *  thumbnails, ImageFilter::Bilinear gives smooth results.
+     *  Images drawn at their natural size are copied either way.
+     *
+     *  @param[in] filter Sampling filter.
+     *
+     *  @internal
+     */
+    void              setImageFilter(ImageFilter filter);
+
+    /**
+     *  @brief Pre evaluates the animated properties for every frame.
+     *
+     *  Every animated scalar, point, color and transform matrix is
+     *  evaluated once per frame and stored, later renders read the
+     *  stored values instead of interpolating keyframes. Meant for short
+     *  loops rendered many times. Path and gradient keyframes are still
+     *  interpolated per frame.
+     *
+     *  The tables belong to the animation data, so animations sharing
+     *  it through the model cache share them as well. They are released
+     *  with the animation data. Load with cachePolicy false to keep them
+     *  to one animation, lottie_animation_bake_timeline() does that.
+     *
+     *  @return Memory used by the baked values in bytes.
+     *
+     *  @internal
+     */
+    size_t            bakeTimeline();
+
+    /**
+     *  @brief Returns a summary of the animation content: layer counts,
+     *  matte / mask / offscreen usage, path complexity and the frame
+     *  range that has visible content.
+     *
+     *  The summary is computed once at load time.
+     *
+     *  @internal
+     */
+    AnimationStats    stats() const;
+
+    /**
+     *  @brief Returns the layer counters of the last rendered frame.
+     *
+     *  @internal
+     */
+    RenderStats       renderStats() const;
+
     /**
      *  @brief Returns root layer of the composition updated with
      *         content of the Lottie resource at frame number @p frameNo.
@@ -507,6 +793,61 @@ private:
     Animation();
 
     std::unique_ptr<AnimationImpl> d;
+
+    friend class AnimationLoader;
+};
+
+/**
+ *  @brief Builds an animation from JSON data that arrives in pieces
+ *  (network download, chunked file read).
+ *
+ *  The model is parsed while the data is being fed, so by the time the
+ *  last chunk arrives most of the parsing work is already done.
+ *
+ *  @internal
+ */
+class RLOTTIE_API AnimationLoader {
+public:
+    /**
+     *  @brief Starts a new incremental load.
+     *
+     *  @param[in] resourcePath the path will be used to search for external resource.
+     *
+     *  @internal
+     */
+    explicit AnimationLoader(std::string resourcePath = "");
+
+    /**
+     *  @brief Appends the next piece of the JSON data.
+     *
+     *  @param[in] data  pointer to the chunk, copied before returning.
+     *  @param[in] size  size of the chunk in bytes.
+     *
+     *  @internal
+     */
+    void feed(const char *data, size_t size);
+
+    /**
+     *  @brief Marks the end of the data and returns the animation.
+     *
+     *  @return Animation object, or nullptr if the data is not a valid
+     *          Lottie resource.
+     *
+     *  @note Must be called once; further calls return nullptr.
+     *
+     *  @internal
+     */
+    std::unique_ptr<Animation> finish();
+
+    /**
+     *  @brief Aborts the load if finish() was not called.
+     *
+     *  @internal
+     */
+    ~AnimationLoader();
+
+private:
+    std::unique_ptr<AnimationLoaderImpl> d;
 };
 
 //Map Property to Value type
@@ -16,6 +16,14 @@
 /* 内部结构定义 */
 struct LottieAnimation {
     std::unique_ptr<rlottie::Animation> animation;
+    std::string            path;     /* set while the model may be cached */
+    rlottie::EasingMode    easing{rlottie::EasingMode::Exact}; /* at load */
+    rlottie::RenderQuality quality{rlottie::RenderQuality::Auto};
+    rlottie::ImageFilter   filter{rlottie::ImageFilter::Nearest};
+};
+
+struct LottieParser {
+    std::unique_ptr<rlottie::AnimationLoader> loader;
 };
 
 /* ========== 加载函数 ========== */
@@ -37,6 +45,8 @@ LottieAnimationHandle lottie_animation_from_file(const char* path)
     }
     
     handle->animation = std::move(animation);
+    handle->path = path;
+    handle->easing = rlottie::easingMode();
     return handle;
 }
 
@@ -69,6 +79,58 @@ LottieAnimationHandle lottie_animation_from_data(
     return handle;
 }
 
+LottieParserHandle lottie_parser_create(const char* resourcePath)
+{
+    LottieParser* parser = new (std::nothrow) LottieParser();
+    if (!parser) {
+        return nullptr;
+    }
+    
+    parser->loader = std::make_unique<rlottie::AnimationLoader>(
+        resourcePath ? resourcePath : "");
+    return parser;
+}
+
+int lottie_parser_feed(LottieParserHandle parser, const char* data, size_t size)
+{
+    if (!parser) {
+        return LOTTIE_ERR_NULL;
+    }
+    if (!data && size) {
+        return LOTTIE_ERR_INVALID;
+    }
+    
+    parser->loader->feed(data, size);
+    return LOTTIE_OK;
+}
+
+LottieAnimationHandle lottie_parser_finish(LottieParserHandle parser)
+{
+    if (!parser) {
+        return nullptr;
+    }
+    
+    auto animation = parser->loader->finish();
+    delete parser;
+    
+    if (!animation) {
+        return nullptr;
+    }
+    
+    LottieAnimation* handle = new (std::nothrow) LottieAnimation();
+    if (!handle) {
+        return nullptr;
+    }
+    
+    handle->animation = std::move(animation);
+    return handle;
+}
+
+void lottie_parser_destroy(LottieParserHandle parser)
+{
+    delete parser;
+}
+
 /* ========== 信息查询 ========== */
 
 int lottie_animation_get_info(
@@ -133,6 +195,37 @@ int lottie_animation_get_size(
     return LOTTIE_OK;
 }
 
+int lottie_animation_get_stats(
+    LottieAnimationHandle handle,
+    LottieAnimationStats* stats)
+{
+    if (!handle || !handle->animation || !stats) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    rlottie::AnimationStats s = handle->animation->stats();
+    stats->layerCount = s.layerCount;
+    stats->shapeLayerCount = s.shapeLayerCount;
+    stats->precompLayerCount = s.precompLayerCount;
+    stats->imageLayerCount = s.imageLayerCount;
+    stats->solidLayerCount = s.solidLayerCount;
+    stats->staticLayerCount = s.staticLayerCount;
+    stats->hiddenLayerCount = s.hiddenLayerCount;
+    stats->matteLayerCount = s.matteLayerCount;
+    stats->maskLayerCount = s.maskLayerCount;
+    stats->offscreenLayerCount = s.offscreenLayerCount;
+    stats->maxPathPoints = s.maxPathPoints;
+    stats->pathCount = s.pathCount;
+    stats->uniquePathCount = s.uniquePathCount;
+    stats->sharedPathBytes = s.sharedPathBytes;
+    stats->activeInFrame = s.activeInFrame;
+    stats->activeOutFrame = s.activeOutFrame;
+    stats->hasContent = s.hasContent ? 1 : 0;
+    stats->isStatic = s.isStatic ? 1 : 0;
+    
+    return LOTTIE_OK;
+}
+
 /* ========== 渲染函数 ========== */
 
 int lottie_animation_render(
@@ -171,6 +264,55 @@ int lottie_animation_render(
     return LOTTIE_OK;
 }
 
+int lottie_animation_render_time(
+    LottieAnimationHandle handle,
+    double seconds,
+    LottieSurface* surface,
+    int keepAspectRatio)
+{
+    if (!handle || !handle->animation) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    if (!surface || !surface->buffer) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    if (surface->width == 0 || surface->height == 0) {
+        return LOTTIE_ERR_INVALID;
+    }
+    
+    rlottie::Surface rlottieSurface(
+        surface->buffer,
+        surface->width,
+        surface->height,
+        surface->bytesPerLine
+    );
+    
+    handle->animation->renderSyncAtTime(
+        seconds,
+        rlottieSurface,
+        keepAspectRatio != 0
+    );
+    
+    return LOTTIE_OK;
+}
+
+int lottie_animation_get_render_stats(
+    LottieAnimationHandle handle,
+    LottieRenderStats* stats)
+{
+    if (!handle || !handle->animation || !stats) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    rlottie::RenderStats s = handle->animation->renderStats();
+    stats->drawnLayerCount = s.drawnLayerCount;
+    stats->culledLayerCount = s.culledLayerCount;
+    
+    return LOTTIE_OK;
+}
+
 size_t lottie_animation_frame_at_pos(
     LottieAnimationHandle handle,
     double pos)
@@ -181,6 +323,89 @@ size_t lottie_animation_frame_at_pos(
     return handle->animation->frameAtPos(pos);
 }
 
+int lottie_animation_set_quality(
+    LottieAnimationHandle handle,
+    int quality)
+{
+    if (!handle || !handle->animation) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    switch (quality) {
+    case LOTTIE_QUALITY_AUTO:
+        handle->quality = rlottie::RenderQuality::Auto;
+        break;
+    case LOTTIE_QUALITY_HIGH:
+        handle->quality = rlottie::RenderQuality::High;
+        break;
+    case LOTTIE_QUALITY_NORMAL:
+        handle->quality = rlottie::RenderQuality::Normal;
+        break;
+    case LOTTIE_QUALITY_FAST:
+        handle->quality = rlottie::RenderQuality::Fast;
+        break;
+    default:
+        return LOTTIE_ERR_INVALID;
+    }
+    handle->animation->setRenderQuality(handle->quality);
+    return LOTTIE_OK;
+}
+
+int lottie_animation_set_image_filter(
+    LottieAnimationHandle handle,
+    int filter)
+{
+    if (!handle || !handle->animation) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    switch (filter) {
+    case LOTTIE_IMAGE_FILTER_NEAREST:
+        handle->filter = rlottie::ImageFilter::Nearest;
+        break;
+    case LOTTIE_IMAGE_FILTER_BILINEAR:
+        handle->filter = rlottie::ImageFilter::Bilinear;
+        break;
+    default:
+        return LOTTIE_ERR_INVALID;
+    }
+    handle->animation->setImageFilter(handle->filter);
+    return LOTTIE_OK;
+}
+
+int lottie_animation_bake_timeline(
+    LottieAnimationHandle handle,
+    size_t* bytes)
+{
+    if (!handle || !handle->animation) {
+        return LOTTIE_ERR_NULL;
+    }
+    
+    /*
+     * The tables are stored in the model, which the model cache shares
+     * with every handle of the same file. Bake a private copy instead
+     * so the other handles keep their memory use, parsed with the easing
+     * mode the handle was loaded with.
+     */
+    if (!handle->path.empty()) {
+        const rlottie::EasingMode easing = rlottie::easingMode();
+        rlottie::configureEasing(handle->easing);
+        auto animation = rlottie::Animation::loadFromFile(handle->path, false);
+        rlottie::configureEasing(easing);
+        if (!animation) {
+            return LOTTIE_ERR_PARSE;
+        }
+        animation->setRenderQuality(handle->quality);
+        animation->setImageFilter(handle->filter);
+        handle->animation = std::move(animation);
+        handle->path.clear();
+    }
+    
+    size_t size = handle->animation->bakeTimeline();
+    if (bytes) *bytes = size;
+    return LOTTIE_OK;
+}
+
 /* ========== 序列化函数 ========== */
 
 char* lottie_animation_to_json(LottieAnimationHandle handle)
@@ -246,6 +471,96 @@ void lottie_configure_cache_size(size_t cacheSize)
     rlottie::configureModelCacheSize(cacheSize);
 }
 
+void lottie_configure_image_cache(size_t bytes)
+{
+    rlottie::configureImageCacheSize(bytes);
+}
+
+void lottie_purge_image_cache(void)
+{
+    rlottie::purgeImageCache();
+}
+
+void lottie_configure_surface_cache(size_t bytes)
+{
+    rlottie::configureSurfaceCacheSize(bytes);
+}
+
+void lottie_purge_surface_cache(void)
+{
+    rlottie::purgeSurfaceCache();
+}
+
+int lottie_get_surface_cache_stats(LottieSurfaceCacheStats* stats)
+{
+    if (!stats) {
+        return LOTTIE_ERR_NULL;
+    }
+
+    rlottie::SurfaceCacheStats s = rlottie::surfaceCacheStats();
+    stats->allocations = s.allocations;
+    stats->reuses = s.reuses;
+    stats->retainedBytes = s.retainedBytes;
+    stats->peakBytes = s.peakBytes;
+    return LOTTIE_OK;
+}
+
+int lottie_configure_rasterizer(int backend)
+{
+    switch (backend) {
+    case LOTTIE_RASTER_GRAY:
+        rlottie::configureRasterBackend(rlottie::RasterBackend::Gray);
+        return LOTTIE_OK;
+    case LOTTIE_RASTER_ACCUM:
+        rlottie::configureRasterBackend(rlottie::RasterBackend::Accumulation);
+        return LOTTIE_OK;
+    default:
+        return LOTTIE_ERR_INVALID;
+    }
+}
+
+int lottie_get_rasterizer(void)
+{
+    return rlottie::rasterBackend() == rlottie::RasterBackend::Accumulation
+               ? LOTTIE_RASTER_ACCUM
+               : LOTTIE_RASTER_GRAY;
+}
+
+int lottie_configure_easing(int mode)
+{
+    switch (mode) {
+    case LOTTIE_EASING_EXACT:
+        rlottie::configureEasing(rlottie::EasingMode::Exact);
+        return LOTTIE_OK;
+    case LOTTIE_EASING_TABLE:
+        rlottie::configureEasing(rlottie::EasingMode::Table);
+        return LOTTIE_OK;
+    default:
+        return LOTTIE_ERR_INVALID;
+    }
+}
+
+int lottie_get_easing(void)
+{
+    return rlottie::easingMode() == rlottie::EasingMode::Table
+               ? LOTTIE_EASING_TABLE
+               : LOTTIE_EASING_EXACT;
+}
+
+int lottie_configure_image_decode(int mode)
+{
+    switch (mode) {
+    case LOTTIE_IMAGE_DECODE_LAZY:
+        rlottie::configureImageDecode(rlottie::ImageDecode::Lazy);
+        return LOTTIE_OK;
+    case LOTTIE_IMAGE_DECODE_PARALLEL:
+        rlottie::configureImageDecode(rlottie::ImageDecode::Parallel);
+        return LOTTIE_OK;
+    default:
+        return LOTTIE_ERR_INVALID;
+    }
+}
+
 /* ========== Pixel Format Conversion ========== */
 
 void lottie_convert_to_straight_alpha(uint32_t* buffer, size_t width, size_t height)
@@ -311,6 +311,9 @@ typedef struct gray_TWorker_ {
     SW_FT_Outline outline;
     SW_FT_BBox    clip_box;
 
+    TPos conic_flat;
+    TPos cubic_flat;
+
     int           bound_left;
     int           bound_top;
     int           bound_right;
@@ -682,7 +685,7 @@ static void gray_render_conic(RAS_ARG_ const SW_FT_Vector* control,
     dy = SW_FT_ABS(arc[2].y + arc[0].y - 2 * arc[1].y);
     if (dx < dy) dx = dy;
 
-    if (dx < ONE_PIXEL / 4) goto Draw;
+    if (dx < ras.conic_flat) goto Draw;
 
     /* short-cut the arc that crosses the current band */
     min = max = arc[0].y;
@@ -701,7 +704,7 @@ static void gray_render_conic(RAS_ARG_ const SW_FT_Vector* control,
     do {
         dx >>= 2;
         level++;
-    } while (dx > ONE_PIXEL / 4);
+    } while (dx > ras.conic_flat);
 
     levels[0] = level;
 
@@ -791,10 +794,10 @@ gray_render_cubic(RAS_ARG_ const SW_FT_Vector* control1,
       /* with each split, control points quickly converge towards  */
       /* chord trisection points and the vanishing distances below */
       /* indicate when the segment is flat enough to draw          */
-      if ( SW_FT_ABS( 2 * arc[0].x - 3 * arc[1].x + arc[3].x ) > ONE_PIXEL / 2 ||
-           SW_FT_ABS( 2 * arc[0].y - 3 * arc[1].y + arc[3].y ) > ONE_PIXEL / 2 ||
-           SW_FT_ABS( arc[0].x - 3 * arc[2].x + 2 * arc[3].x ) > ONE_PIXEL / 2 ||
-           SW_FT_ABS( arc[0].y - 3 * arc[2].y + 2 * arc[3].y ) > ONE_PIXEL / 2 )
+      if ( SW_FT_ABS( 2 * arc[0].x - 3 * arc[1].x + arc[3].x ) > ras.cubic_flat ||
+           SW_FT_ABS( 2 * arc[0].y - 3 * arc[1].y + arc[3].y ) > ras.cubic_flat ||
+           SW_FT_ABS( arc[0].x - 3 * arc[2].x + 2 * arc[3].x ) > ras.cubic_flat ||
+           SW_FT_ABS( arc[0].y - 3 * arc[2].y + 2 * arc[3].y ) > ras.cubic_flat )
         goto Split;
 
       gray_render_line( RAS_VAR_ arc[0].x, arc[0].y );
@@ -1373,6 +1376,16 @@ static int gray_raster_render(gray_PRaster               raster,
         ras.clip_box.yMax = 32767L;
     }
 
+    /* flattening tolerance, half a pixel for cubics and a quarter */
+    /* for conics unless the caller asked for something coarser    */
+    if (params->flatness > 0) {
+        ras.cubic_flat = UPSCALE(params->flatness);
+        ras.conic_flat = ras.cubic_flat / 2;
+    } else {
+        ras.cubic_flat = ONE_PIXEL / 2;
+        ras.conic_flat = ONE_PIXEL / 4;
+    }
+
     gray_init_cells(RAS_VAR_ buffer, buffer_size);
 
     ras.outline = *outline;
@@ -372,6 +372,10 @@ typedef struct  SW_FT_Outline_
   /*                   should be expressed in _integer_ pixels (and not in */
   /*                   26.6 fixed-point units).                            */
   /*                                                                       */
+  /*    flatness    :: Maximum distance in 26.6 units between a curve and  */
+  /*                   the lines it is flattened into.  0 selects the      */
+  /*                   default of half a pixel.                            */
+  /*                                                                       */
   /* <Note>                                                                */
   /*    An anti-aliased glyph bitmap is drawn if the @SW_FT_RASTER_FLAG_AA    */
   /*    bit flag is set in the `flags' field, otherwise a monochrome       */
@@ -397,6 +401,7 @@ typedef struct  SW_FT_Outline_
     SW_FT_BboxFunc          bbox_cb;
     void*                   user;
     SW_FT_BBox              clip_box;
+    SW_FT_Pos               flatness;
 
   } SW_FT_Raster_Params;
 
@@ -21,6 +21,7 @@
  */
 
 #include "vbitmap.h"
+#include <cstring>
 #include <string>
 #include <memory>
 #include "vdrawhelper.h"
@@ -30,7 +31,15 @@ V_BEGIN_NAMESPACE
 
 void VBitmap::Impl::reset(size_t width, size_t height, VBitmap::Format format)
 {
+    // clear the drawn pixels in the old layout, a reused buffer is then
+    // zero whatever the new geometry is.
+    if (mRoData) {
+        mDirty = VRect();
+    } else {
+        clearDirty();
+    }
     mRoData = nullptr;
+    mOpaque = false;
     mWidth = uint32_t(width);
     mHeight = uint32_t(height);
     mFormat = format;
@@ -38,7 +47,34 @@ void VBitmap::Impl::reset(size_t width, size_t height, VBitmap::Format format)
     mDepth = depth(format);
     mStride = ((mWidth * mDepth + 31) >> 5)
                   << 2;  // bytes per scanline (must be multiple of 4)
-    mOwnData = std::make_unique<uint8_t[]>(mStride * mHeight);
+    reserve(size_t(mStride) * mHeight);
+}
+
+void VBitmap::Impl::reserve(size_t bytes)
+{
+    if (mOwnData && mCapacity >= bytes) return;
+
+    mOwnData = std::make_unique<uint8_t[]>(bytes);
+    mCapacity = bytes;
+    mDirty = VRect();
+}
+
+void VBitmap::Impl::clearDirty()
+{
+    VRect r = mDirty & rect();
+    mDirty = VRect();
+    if (r.empty()) return;
+
+    uint8_t *row = data() + size_t(r.y()) * mStride;
+    if (size_t(r.width()) == mWidth) {
+        memset(row, 0, size_t(r.height()) * mStride);
+        return;
+    }
+
+    size_t bpp = mDepth / 8;
+    size_t len = size_t(r.width()) * bpp;
+    row += size_t(r.x()) * bpp;
+    for (int y = 0; y < r.height(); y++, row += mStride) memset(row, 0, len);
 }
 
 void VBitmap::Impl::reset(uint8_t *data, size_t width, size_t height,
@@ -51,6 +87,10 @@ void VBitmap::Impl::reset(uint8_t *data, size_t width, size_t height,
     mFormat = format;
     mDepth = depth(format);
     mOwnData = nullptr;
+    mCapacity = 0;
+    mOpaque = false;
+    // the content of a foreign buffer is unknown.
+    mDirty = rect();
 }
 
 uint8_t VBitmap::Impl::depth(VBitmap::Format format)
@@ -82,24 +122,7 @@ void VBitmap::Impl::updateLuma()
     for (uint32_t col = 0; col < mHeight; col++) {
         uint32_t *pixel = (uint32_t *)(dataPtr + mStride * col);
         for (uint32_t row = 0; row < mWidth; row++) {
-            int alpha = vAlpha(*pixel);
-            if (alpha == 0) {
-                pixel++;
-                continue;
-            }
-
-            int red = vRed(*pixel);
-            int green = vGreen(*pixel);
-            int blue = vBlue(*pixel);
-
-            if (alpha != 255) {
-                // un multiply
-                red = (red * 255) / alpha;
-                green = (green * 255) / alpha;
-                blue = (blue * 255) / alpha;
-            }
-            int luminosity = int(0.299f * red + 0.587f * green + 0.114f * blue);
-            *pixel = luminosity << 24;
+            *pixel = vLuma(*pixel) << 24;
             pixel++;
         }
     }
@@ -145,6 +168,17 @@ void VBitmap::reset(size_t w, size_t h, VBitmap::Format format)
     }
 }
 
+void VBitmap::reserve(size_t bytes)
+{
+    if (!mImpl) mImpl = rc_ptr<Impl>(0, 0, Format::ARGB32_Premultiplied);
+    mImpl->reserve(bytes);
+}
+
+size_t VBitmap::capacity() const
+{
+    return mImpl ? mImpl->mCapacity : 0;
+}
+
 size_t VBitmap::stride() const
 {
     return mImpl ? mImpl->stride() : 0;
@@ -185,6 +219,31 @@ VSize VBitmap::size() const
     return mImpl ? mImpl->size() : VSize();
 }
 
+VRect VBitmap::dirtyRect() const
+{
+    return mImpl ? mImpl->mDirty : VRect();
+}
+
+void VBitmap::addDirtyRect(const VRect &rect)
+{
+    if (mImpl) mImpl->mDirty = mImpl->mDirty.united(rect);
+}
+
+void VBitmap::clearDirty()
+{
+    if (mImpl) mImpl->clearDirty();
+}
+
+bool VBitmap::opaque() const
+{
+    return mImpl ? mImpl->mOpaque : false;
+}
+
+void VBitmap::setOpaque(bool opaque)
+{
+    if (mImpl) mImpl->mOpaque = opaque;
+}
+
 bool VBitmap::valid() const
 {
     return mImpl;
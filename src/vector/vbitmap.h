@@ -43,7 +43,12 @@ public:
             VBitmap::Format format);
     void reset(uint8_t *data, size_t w, size_t h, size_t stride,
                VBitmap::Format format);
+    // keeps the pixel buffer when it is large enough, the content is
+    // undefined after a resize.
     void reset(size_t w, size_t h, VBitmap::Format format=Format::ARGB32_Premultiplied);
+    // makes the owned pixel buffer at least bytes large.
+    void reserve(size_t bytes);
+    size_t          capacity() const;
     size_t          stride() const;
     size_t          width() const;
     size_t          height() const;
@@ -54,6 +59,16 @@ public:
     uint8_t *       data() const;
     VRect           rect() const;
     VSize           size() const;
+    // area that may hold non zero pixels, the rest of an owned buffer is
+    // clear. VPainter keeps it up to date, other writers have to report
+    // their pixels with addDirtyRect().
+    VRect           dirtyRect() const;
+    void            addDirtyRect(const VRect &rect);
+    // zeroes the dirty area only.
+    void            clearDirty();
+    // every pixel has full alpha, reported by the writer of the pixels.
+    bool            opaque() const;
+    void            setOpaque(bool opaque);
     void            fill(uint32_t pixel);
     void    updateLuma();
 private:
@@ -63,7 +78,13 @@ private:
         uint32_t                   mWidth{0};
         uint32_t                   mHeight{0};
         uint32_t                   mStride{0};
+        size_t                     mCapacity{0};  // size of mOwnData
+        // a single rect instead of per row spans, the offscreen surfaces
+        // of the renderer are sized to the layer's drawn bounds so the
+        // drawn area covers most of them anyway.
+        VRect                      mDirty;
         uint8_t                    mDepth{0};
+        bool                       mOpaque{false};
         VBitmap::Format mFormat{VBitmap::Format::Invalid};
 
         explicit Impl(size_t width, size_t height, VBitmap::Format format)
@@ -84,6 +105,8 @@ private:
         VBitmap::Format format() const { return mFormat; }
         void reset(uint8_t *, size_t, size_t, size_t, VBitmap::Format);
         void reset(size_t, size_t, VBitmap::Format);
+        void reserve(size_t bytes);
+        void clearDirty();
         static uint8_t depth(VBitmap::Format format);
         void fill(uint32_t);
         void updateLuma();
@@ -66,4 +66,16 @@ VBrush::VBrush(const VTexture *texture):mType(VBrush::Type::Texture), mTexture(t
 {
 }
 
+bool VBrush::opaque() const
+{
+    switch (mType) {
+    case Type::Solid:
+        return mColor.alpha() == 255;
+    case Type::Texture:
+        return mTexture->mAlpha == 255 && mTexture->mBitmap.opaque();
+    default:
+        return false;
+    }
+}
+
 V_END_NAMESPACE
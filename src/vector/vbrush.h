@@ -67,6 +67,7 @@ struct VTexture {
     VBitmap  mBitmap;
     VMatrix  mMatrix;
     int      mAlpha{255};
+    bool     mBilinear{false};  // filter when scaled or rotated
 };
 
 class VBrush {
@@ -78,6 +79,8 @@ public:
     explicit VBrush(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
     explicit VBrush(const VTexture *texture);
     inline VBrush::Type type() const { return mType; }
+    // paints every covered pixel with full alpha.
+    bool opaque() const;
 public:
     VBrush::Type     mType{Type::NoBrush};
     union {
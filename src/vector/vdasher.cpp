@@ -225,7 +225,7 @@ void VDasher::dashHelper(const VPath &path, VPath &result)
 
 void VDasher::dashed(const VPath &path, VPath &result)
 {
-    if (mNoLength && mNoGap) return result.reset();
+    if (mNoLength && mNoGap) return result.clone(path);
 
     if (path.empty() || mNoLength) return result.reset();
 
@@ -21,7 +21,6 @@
  */
 
 #include "vdrawable.h"
-#include "vdasher.h"
 #include "vraster.h"
 
 VDrawable::VDrawable(VDrawable::Type type)
@@ -50,35 +49,74 @@ void VDrawable::setType(VDrawable::Type type)
     }
 }
 
-void VDrawable::applyDashOp()
+void VDrawable::preprocess(const VRect &clip, float flatness)
 {
-    if (mStrokeInfo && (mType == Type::StrokeWithDash)) {
+    if (mInstance && mInstance->mSource) {
+        // the source may not be drawn itself (e.g. a transparent copy).
+        mInstance->mSource->preprocess(clip, flatness);
+        mInstance->mClip = clip;
+        mInstance->mFlatness = flatness;
+        mInstance->mDirty = true;
+        return;
+    }
+
+    if (mFlag & (DirtyState::Path)) rasterize(clip, flatness);
+}
+
+void VDrawable::rasterize(const VRect &clip, float flatness)
+{
+    if (mType == Type::Fill) {
+        mRasterizer.rasterize(std::move(mPath), mFillRule, clip, flatness);
+    } else if (mType == Type::StrokeWithDash) {
         auto obj = static_cast<StrokeWithDashInfo *>(mStrokeInfo);
-        if (!obj->mDash.empty()) {
-            VDasher dasher(obj->mDash.data(), obj->mDash.size());
-            mPath.clone(dasher.dashed(mPath));
-        }
+        mRasterizer.rasterize(std::move(mPath), obj->cap, obj->join,
+                              obj->width, obj->miterLimit, obj->mDash,
+                              clip, flatness);
+    } else {
+        mRasterizer.rasterize(std::move(mPath), mStrokeInfo->cap, mStrokeInfo->join,
+                              mStrokeInfo->width, mStrokeInfo->miterLimit, clip,
+                              flatness);
     }
+    mPath = {};
+    mFlag &= ~DirtyFlag(DirtyState::Path);
 }
 
-void VDrawable::preprocess(const VRect &clip)
+VRle VDrawable::rle()
 {
-    if (mFlag & (DirtyState::Path)) {
-        if (mType == Type::Fill) {
-            mRasterizer.rasterize(std::move(mPath), mFillRule, clip);
+    if (!mInstance || !mInstance->mSource) return mRasterizer.rle();
+
+    auto &instance = *mInstance;
+    if (instance.mDirty) {
+        instance.mDirty = false;
+
+        // a source touching the clip border may have lost some coverage
+        // the moved copy needs, rasterize the own path then.
+        const VRect &clip = instance.mClip;
+        VRle source = instance.mSource->rle();
+        if (source.empty() || clip.contains(source.boundingRect(), true)) {
+            source.translate(instance.mOffset);
+            if (clip.contains(source.boundingRect()))
+                instance.mRle = std::move(source);
+            else
+                instance.mRle = clip & source;
         } else {
-            applyDashOp();
-            mRasterizer.rasterize(std::move(mPath), mStrokeInfo->cap, mStrokeInfo->join,
-                                  mStrokeInfo->width, mStrokeInfo->miterLimit, clip);
+            if (mFlag & (DirtyState::Path))
+                rasterize(instance.mClip, instance.mFlatness);
+            instance.mRle = mRasterizer.rle();
         }
-        mPath = {};
-        mFlag &= ~DirtyFlag(DirtyState::Path);
     }
+    return instance.mRle;
 }
 
-VRle VDrawable::rle()
+void VDrawable::setInstance(VDrawable *source, const VPoint &offset)
 {
-    return mRasterizer.rle();
+    if (!source) {
+        mInstance.reset();
+        return;
+    }
+    if (!mInstance) mInstance = std::make_unique<Instance>();
+    mInstance->mSource = source;
+    mInstance->mOffset = offset;
 }
 
 void VDrawable::setStrokeInfo(CapStyle cap, JoinStyle join, float miterLimit,
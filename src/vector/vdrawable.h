@@ -24,6 +24,7 @@
 #define VDRAWABLE_H
 #include <future>
 #include <cstring>
+#include <memory>
 #include "vbrush.h"
 #include "vpath.h"
 #include "vrle.h"
@@ -56,9 +57,12 @@ public:
     void setStrokeInfo(CapStyle cap, JoinStyle join, float miterLimit,
                        float strokeWidth);
     void setDashInfo(std::vector<float> &dashInfo);
-    void preprocess(const VRect &clip);
-    void applyDashOp();
+    void preprocess(const VRect &clip, float flatness);
     VRle rle();
+    // draws the coverage of source moved by offset instead of rasterizing
+    // its own path, which is only used when the source got clipped.
+    // nullptr goes back to rasterizing.
+    void setInstance(VDrawable *source, const VPoint &offset);
     void setName(const char *name)
     {
         mName = name;
@@ -77,11 +81,24 @@ public:
         std::vector<float> mDash;
     };
 
+    struct Instance {
+        VDrawable *mSource{nullptr};
+        VPoint     mOffset;
+        VRect      mClip;
+        float      mFlatness{0};
+        VRle       mRle;
+        bool       mDirty{true};  // mRle is from an older frame
+    };
+
+private:
+    void rasterize(const VRect &clip, float flatness);
+
 public:
     VPath                    mPath;
     VBrush                   mBrush;
     VRasterizer              mRasterizer;
     StrokeInfo              *mStrokeInfo{nullptr};
+    std::unique_ptr<Instance> mInstance;
 
     DirtyFlag                mFlag{DirtyState::All};
     FillRule                 mFillRule{FillRule::Winding};
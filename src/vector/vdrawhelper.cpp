@@ -198,6 +198,7 @@ VBitmap::Format VRasterBuffer::prepare(const VBitmap *image)
 void VSpanData::init(VRasterBuffer *image)
 {
     mRasterBuffer = image;
+    mOrigin = VPoint();
     setDrawRegion(VRect(0, 0, int(image->width()), int(image->height())));
     mType = VSpanData::Type::None;
     mBlendFunc = nullptr;
@@ -485,6 +486,9 @@ static inline Operator getOperator(const VSpanData *data)
 {
     Operator op;
     bool     solidSource = false;
+    // only full coverage can skip the blend, a partial one has to round
+    // like SrcOver does.
+    bool     opaqueSource = false;
 
     switch (data->mType) {
     case VSpanData::Type::Solid:
@@ -492,7 +496,9 @@ static inline Operator getOperator(const VSpanData *data)
         op.srcFetch = nullptr;
         break;
     case VSpanData::Type::LinearGradient:
-        solidSource = false;
+        // an affine linear gradient only fetches colors of the table.
+        opaqueSource = !data->mGradient.mColorTableAlpha && !data->m13 &&
+                       !data->m23;
         getLinearGradientValues(&op.linear, data);
         op.srcFetch = &fetch_linear_gradient;
         break;
@@ -501,6 +507,10 @@ static inline Operator getOperator(const VSpanData *data)
         getRadialGradientValues(&op.radial, data);
         op.srcFetch = &fetch_radial_gradient;
         break;
+    case VSpanData::Type::Texture:
+        opaqueSource = !data->mTexture.hasAlpha;
+        op.srcFetch = nullptr;
+        break;
     default:
         op.srcFetch = nullptr;
         break;
@@ -511,19 +521,63 @@ static inline Operator getOperator(const VSpanData *data)
 
     op.funcSolid = RenderTable.color(op.mode);
     op.func = RenderTable.src(op.mode);
+    op.funcCovered = op.func;
+    if (op.mode == BlendMode::SrcOver && opaqueSource)
+        op.funcCovered = RenderTable.src(BlendMode::Src);
 
     return op;
 }
 
+static inline void blend_src(const Operator &op, uint32_t *dest, int length,
+                             const uint32_t *src, uint32_t coverage)
+{
+    if (coverage == 255)
+        op.funcCovered(dest, length, src, coverage);
+    else
+        op.func(dest, length, src, coverage);
+}
+
 static void blend_color(size_t size, const VRle::Span *array, void *userData)
 {
     VSpanData *data = (VSpanData *)(userData);
     Operator   op = getOperator(data);
     const uint32_t color = data->mSolid;
+    // a fully covered span of an opaque color is a plain fill.
+    const bool fill = (op.mode == BlendMode::Src);
+
+    // every pixel is blended on its own, so adjacent spans with the same
+    // coverage go in one call. A run reaching the right end of the buffer
+    // goes on at the left end of the next row if the rows are packed.
+    const auto *buffer = data->mRasterBuffer;
+    const int   left = -data->mOffset.x();
+    const int   right = left + int(buffer->width());
+    const bool  packed = buffer->bytesPerLine() ==
+                        buffer->width() * buffer->bytesPerPixel();
+
+    const VRle::Span *end = array + size;
+    while (array < end) {
+        const auto &span = *array;
+        int         x = span.x + span.len;
+        int         y = span.y;
+        int         len = span.len;
+        for (++array; array < end && array->coverage == span.coverage;
+             ++array) {
+            if (array->y == y && array->x == x) {
+            } else if (packed && x == right && array->y == y + 1 &&
+                       array->x == left) {
+                y++;
+            } else {
+                break;
+            }
+            x = array->x + array->len;
+            len += array->len;
+        }
 
-    for (size_t i = 0 ; i < size; ++i) {
-        const auto &span = array[i];
-        op.funcSolid(data->buffer(span.x, span.y), span.len, color, span.coverage);
+        uint32_t *dest = data->buffer(span.x, span.y);
+        if (fill && span.coverage == 255)
+            memfill32(dest, color, len);
+        else
+            op.funcSolid(dest, len, color, span.coverage);
     }
 }
 
@@ -534,10 +588,17 @@ static inline void process_in_chunk(const VRle::Span *array, size_t size,
                                     Process process)
 {
     std::array<uint32_t, 2048> buf;
-    for (size_t i = 0; i < size; i++) {
+    for (size_t i = 0; i < size;) {
         const auto &span = array[i];
         size_t      len = span.len;
         auto        x = span.x;
+        // adjacent spans of a row with the same coverage are one run.
+        for (i++; i < size && array[i].y == span.y &&
+                  array[i].x == x + int(len) &&
+                  array[i].coverage == span.coverage;
+             i++) {
+            len += array[i].len;
+        }
         while (len) {
             auto l = std::min(len, buf.size());
             process(buf.data(), x, span.y, l, span.coverage);
@@ -559,7 +620,8 @@ static void blend_gradient(size_t size, const VRle::Span *array,
         array, size,
         [&](uint32_t *scratch, size_t x, size_t y, size_t len, uint8_t cov) {
             op.srcFetch(scratch, &op, data, (int)y, (int)x, (int)len);
-            op.func(data->buffer((int)x, (int)y), (int)len, scratch, cov);
+            blend_src(op, data->buffer((int)x, (int)y), (int)len, scratch,
+                      cov);
         });
 }
 
@@ -571,7 +633,8 @@ constexpr const T &clamp(const T &v, const T &lo, const T &hi)
 
 static constexpr inline uint8_t alpha_mul(uint8_t a, uint8_t b)
 {
-    return ((a * b) >> 8);
+    // full alpha leaves the coverage exact, an opaque image stays opaque.
+    return b == 255 ? a : ((a * b) >> 8);
 }
 
 static void blend_image_xform(size_t size, const VRle::Span *array,
@@ -591,17 +654,74 @@ static void blend_image_xform(size_t size, const VRle::Span *array,
     process_in_chunk(
         array, size,
         [&](uint32_t *scratch, size_t x, size_t y, size_t len, uint8_t cov) {
-            const auto  coverage = (cov * src.alpha()) >> 8;
+            const auto  coverage = alpha_mul(cov, src.alpha());
             const float xfactor = y * data->m21 + data->dx + data->m11;
             const float yfactor = y * data->m22 + data->dy + data->m12;
-            for (size_t i = 0; i < len; i++) {
-                const float fx = (x + i) * data->m11 + xfactor;
-                const float fy = (x + i) * data->m12 + yfactor;
-                const int   px = clamp(int(fx), src.left, src.right);
-                const int   py = clamp(int(fy), src.top, src.bottom);
-                scratch[i] = src.pixel(px, py);
-            }
-            op.func(data->buffer((int)x, (int)y), (int)len, scratch, coverage);
+            fetch_nearest(scratch, src, (int)x, (int)len, data->m11, xfactor,
+                          data->m12, yfactor);
+            blend_src(op, data->buffer((int)x, (int)y), (int)len, scratch,
+                      coverage);
+        });
+}
+
+static void blend_image_scale(size_t size, const VRle::Span *array,
+                              void *userData)
+{
+    const auto  data = reinterpret_cast<const VSpanData *>(userData);
+    const auto &src = data->texture();
+
+    if (src.format() != VBitmap::Format::ARGB32_Premultiplied &&
+        src.format() != VBitmap::Format::ARGB32) {
+        //@TODO other formats not yet handled.
+        return;
+    }
+
+    Operator op = getOperator(data);
+
+    // same sampling as blend_image_xform, without rotation a span reads a
+    // single row of the texture.
+    process_in_chunk(
+        array, size,
+        [&](uint32_t *scratch, size_t x, size_t y, size_t len, uint8_t cov) {
+            const auto  coverage = alpha_mul(cov, src.alpha());
+            const float xfactor = y * data->m21 + data->dx + data->m11;
+            const float yfactor = y * data->m22 + data->dy + data->m12;
+            const int   py = clamp(int(yfactor), src.top, src.bottom);
+            fetch_nearest_row(scratch, src.pixelRef(0, py), (int)x, (int)len,
+                              data->m11, xfactor, src.left, src.right);
+            blend_src(op, data->buffer((int)x, (int)y), (int)len, scratch,
+                      coverage);
+        });
+}
+
+static void blend_image_bilinear(size_t size, const VRle::Span *array,
+                                 void *userData)
+{
+    const auto  data = reinterpret_cast<const VSpanData *>(userData);
+    const auto &src = data->texture();
+
+    if (src.format() != VBitmap::Format::ARGB32_Premultiplied &&
+        src.format() != VBitmap::Format::ARGB32) {
+        //@TODO other formats not yet handled.
+        return;
+    }
+
+    Operator op = getOperator(data);
+
+    process_in_chunk(
+        array, size,
+        [&](uint32_t *scratch, size_t x, size_t y, size_t len, uint8_t cov) {
+            const auto coverage = alpha_mul(cov, src.alpha());
+            // pixel centers mapped into the texture, relative to the
+            // texel centers.
+            const float cx = x + 0.5f;
+            const float cy = y + 0.5f;
+            const float fx = data->m11 * cx + data->m21 * cy + data->dx - 0.5f;
+            const float fy = data->m12 * cx + data->m22 * cy + data->dy - 0.5f;
+            fetch_bilinear(scratch, (int)len, src, fx, fy, data->m11,
+                           data->m12);
+            blend_src(op, data->buffer((int)x, (int)y), (int)len, scratch,
+                      coverage);
         });
 }
 
@@ -639,8 +759,8 @@ static void blend_image(size_t size, const VRle::Span *array, void *userData)
         // intersecting right edge of image
         if (sx + length > int(src.width())) length = (int)src.width() - sx;
 
-        op.func(data->buffer(x, span.y), length, src.pixelRef(sx, sy),
-                alpha_mul(span.coverage, src.alpha()));
+        blend_src(op, data->buffer(x, span.y), length, src.pixelRef(sx, sy),
+                  alpha_mul(span.coverage, src.alpha()));
     }
 }
 
@@ -688,6 +808,7 @@ void VSpanData::setup(const VBrush &brush, BlendMode /*mode*/, int /*alpha*/)
         mType = VSpanData::Type::Texture;
         initTexture(&brush.mTexture->mBitmap, brush.mTexture->mAlpha,
                     brush.mTexture->mBitmap.rect());
+        mTexture.bilinear = brush.mTexture->mBilinear;
         setupMatrix(brush.mTexture->mMatrix);
         break;
     }
@@ -722,7 +843,10 @@ void VSpanData::initTexture(const VBitmap *bitmap, int alpha,
                             const VRect &sourceRect)
 {
     mType = VSpanData::Type::Texture;
+    transformType = VMatrix::MatrixType::None;
     mTexture.prepare(bitmap);
+    mTexture.hasAlpha = !bitmap->opaque();
+    mTexture.bilinear = false;
     mTexture.setClip(sourceRect);
     mTexture.setAlpha(alpha);
     updateSpanFunc();
@@ -743,9 +867,12 @@ void VSpanData::updateSpanFunc()
         break;
     }
     case VSpanData::Type::Texture: {
-        //@TODO update proper image function.
         if (transformType <= VMatrix::MatrixType::Translate) {
             mUnclippedBlendFunc = &blend_image;
+        } else if (mTexture.bilinear && fast_matrix) {
+            mUnclippedBlendFunc = &blend_image_bilinear;
+        } else if (transformType <= VMatrix::MatrixType::Scale) {
+            mUnclippedBlendFunc = &blend_image_scale;
         } else {
             mUnclippedBlendFunc = &blend_image_xform;
         }
@@ -764,3 +891,43 @@ void memfill32(uint32_t *dest, uint32_t value, int length)
 }
 #endif
 
+#if !defined(__SSE2__)
+void fetch_nearest(uint32_t *dest, const VTextureData &src, int x, int length,
+                   float sx, float ox, float sy, float oy)
+{
+    for (int i = 0; i < length; i++) {
+        const int px = clamp(int(float(x + i) * sx + ox), src.left, src.right);
+        const int py = clamp(int(float(x + i) * sy + oy), src.top, src.bottom);
+        dest[i] = src.pixel(px, py);
+    }
+}
+
+void fetch_nearest_row(uint32_t *dest, const uint32_t *row, int x, int length,
+                       float sx, float offset, int left, int right)
+{
+    for (int i = 0; i < length; i++) {
+        dest[i] = row[clamp(int(float(x + i) * sx + offset), left, right)];
+    }
+}
+
+void fetch_bilinear(uint32_t *dest, int length, const VTextureData &src,
+                    float fx, float fy, float fdx, float fdy)
+{
+    // one texel outside the clip is enough, the weights only need to
+    // reach the edge texels there.
+    const float xlo = float(src.left - 1), xhi = float(src.right + 1);
+    const float ylo = float(src.top - 1), yhi = float(src.bottom + 1);
+    uint32_t    texels[4], distx, disty;
+    for (int i = 0; i < length; i++) {
+        const float px = clamp(fx + float(i) * fdx, xlo, xhi);
+        const float py = clamp(fy + float(i) * fdy, ylo, yhi);
+        bilinear_texels(src, int(px * 256), int(py * 256), texels, distx,
+                        disty);
+        const uint32_t top =
+            interpolate_pixel(texels[0], 256 - distx, texels[1], distx);
+        const uint32_t bottom =
+            interpolate_pixel(texels[2], 256 - distx, texels[3], distx);
+        dest[i] = interpolate_pixel(top, 256 - disty, bottom, disty);
+    }
+}
+#endif
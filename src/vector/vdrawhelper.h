@@ -34,6 +34,7 @@
 V_USE_NAMESPACE
 
 struct VSpanData;
+struct VTextureData;
 struct Operator;
 
 struct RenderFunc
@@ -92,6 +93,22 @@ typedef void (*ProcessRleSpan)(size_t count, const VRle::Span *spans,
 
 extern void memfill32(uint32_t *dest, uint32_t value, int count);
 
+// nearest texels of a row at positions (x + i) * sx + offset, clamped to
+// [left, right].
+extern void fetch_nearest_row(uint32_t *dest, const uint32_t *row, int x,
+                              int length, float sx, float offset, int left,
+                              int right);
+
+// nearest texels at positions ((x + i) * sx + ox, (x + i) * sy + oy),
+// clamped to the texture clip.
+extern void fetch_nearest(uint32_t *dest, const VTextureData &src, int x,
+                          int length, float sx, float ox, float sy, float oy);
+
+// texels at positions (fx, fy) + i * (fdx, fdy) filtered between the four
+// nearest ones, clamped to the texture clip.
+extern void fetch_bilinear(uint32_t *dest, int length, const VTextureData &src,
+                           float fx, float fy, float fdx, float fdy);
+
 struct LinearGradientValues {
     float dx;
     float dy;
@@ -114,6 +131,8 @@ struct Operator {
     SourceFetchProc          srcFetch;
     RenderFunc::Color        funcSolid;
     RenderFunc::Src          func;
+    // func for a const_alpha of 255, a plain copy if the source is opaque.
+    RenderFunc::Src          funcCovered;
     union {
         LinearGradientValues linear;
         RadialGradientValues radial;
@@ -180,6 +199,7 @@ struct VTextureData : public VRasterBuffer {
     int   top;
     int   bottom;
     bool  hasAlpha;
+    bool  bilinear;
     uint8_t mAlpha;
 };
 
@@ -197,10 +217,7 @@ struct VSpanData {
                int alpha = 255);
     void setupMatrix(const VMatrix &matrix);
 
-    VRect clipRect() const
-    {
-        return VRect(0, 0, mDrawableSize.width(), mDrawableSize.height());
-    }
+    VRect clipRect() const { return VRect(mOrigin, mDrawableSize); }
 
     void setDrawRegion(const VRect &region)
     {
@@ -208,6 +225,15 @@ struct VSpanData {
         mDrawableSize = VSize(region.width(), region.height());
     }
 
+    // the buffer holds the canvas area starting at origin instead of
+    // (0, 0). Spans stay in canvas coordinates.
+    void setOrigin(const VPoint &origin)
+    {
+        mOffset += mOrigin;
+        mOffset -= origin;
+        mOrigin = origin;
+    }
+
     uint32_t *buffer(int x, int y) const
     {
         return mRasterBuffer->pixelRef(x + mOffset.x(), y + mOffset.y());
@@ -222,6 +248,7 @@ struct VSpanData {
     VSpanData::Type                    mType;
     std::shared_ptr<const VColorTable> mColorTable{nullptr};
     VPoint                             mOffset;  // offset to the subsurface
+    VPoint                             mOrigin;  // canvas position of the buffer
     VSize                              mDrawableSize;  // suburface size
     uint32_t                           mSolid;
     VGradientData                      mGradient;
@@ -256,6 +283,20 @@ inline constexpr int vAlpha(uint32_t c)
     return c >> 24;
 }
 
+// 255 * 0x10000 / a, un-premultiplies a channel with a multiply.
+extern uint32_t vUnpremultiplyTable[256];
+
+// luminance of a premultiplied pixel (BT.601 weights) from its straight
+// color, the alpha a luma matte applies.
+static inline uint32_t vLuma(uint32_t c)
+{
+    uint32_t a = uint32_t(vAlpha(c));
+    uint32_t l = 77 * vRed(c) + 150 * vGreen(c) + 29 * vBlue(c);
+    if (a == 255) return (l + 128) >> 8;
+    l = uint32_t((uint64_t(l) * vUnpremultiplyTable[a] + 0x800000) >> 24);
+    return l > 255 ? 255 : l;
+}
+
 static inline uint32_t interpolate_pixel(uint32_t x, uint32_t a, uint32_t y,
                                          uint32_t b)
 {
@@ -268,4 +309,26 @@ static inline uint32_t interpolate_pixel(uint32_t x, uint32_t a, uint32_t y,
     return x;
 }
 
+// a texel position in 24.8 fixed point split into the clamped texels around
+// it and the weights of the right and bottom ones.
+static inline void bilinear_texels(const VTextureData &src, int fx, int fy,
+                                   uint32_t texels[4], uint32_t &distx,
+                                   uint32_t &disty)
+{
+    int x1 = fx >> 8, y1 = fy >> 8;
+    int x2 = x1 + 1, y2 = y1 + 1;
+    distx = uint32_t(fx & 0xff);
+    disty = uint32_t(fy & 0xff);
+    x1 = x1 < src.left ? src.left : x1 > src.right ? src.right : x1;
+    x2 = x2 < src.left ? src.left : x2 > src.right ? src.right : x2;
+    y1 = y1 < src.top ? src.top : y1 > src.bottom ? src.bottom : y1;
+    y2 = y2 < src.top ? src.top : y2 > src.bottom ? src.bottom : y2;
+    const uint32_t *r1 = src.pixelRef(0, y1);
+    const uint32_t *r2 = src.pixelRef(0, y2);
+    texels[0] = r1[x1];
+    texels[1] = r1[x2];
+    texels[2] = r2[x1];
+    texels[3] = r2[x2];
+}
+
 #endif  // QDRAWHELPER_P_H
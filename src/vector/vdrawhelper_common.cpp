@@ -23,6 +23,16 @@
 #include <cstring>
 #include "vdrawhelper.h"
 
+uint32_t vUnpremultiplyTable[256];
+
+static void initUnpremultiplyTable()
+{
+    vUnpremultiplyTable[0] = 0;
+    for (uint32_t a = 1; a < 256; a++)
+        vUnpremultiplyTable[a] = (255 * 0x10000 + a / 2) / a;
+}
+V_CONSTRUCTOR_FUNCTION(initUnpremultiplyTable)
+
 /*
 result = s
 dest = s * ca + d * cia
@@ -168,17 +178,68 @@ static void src_DestinationOut(uint32_t *dest, int length, const uint32_t *src,
     }
 }
 
+/* same as DestIn / DestOut with the luminance of the source as its alpha,
+ * saves converting the whole matte buffer before compositing.
+ */
+static void color_LumaIn(uint32_t *dest, int length, uint32_t color,
+                         uint32_t alpha)
+{
+    color_DestinationIn(dest, length, vLuma(color) << 24, alpha);
+}
+
+static void color_LumaOut(uint32_t *dest, int length, uint32_t color,
+                          uint32_t alpha)
+{
+    color_DestinationOut(dest, length, vLuma(color) << 24, alpha);
+}
+
+static void src_LumaIn(uint32_t *dest, int length, const uint32_t *src,
+                       uint32_t alpha)
+{
+    if (alpha == 255) {
+        for (int i = 0; i < length; ++i) {
+            dest[i] = BYTE_MUL(dest[i], vLuma(src[i]));
+        }
+    } else {
+        uint32_t cia = 255 - alpha;
+        for (int i = 0; i < length; ++i) {
+            uint32_t a = BYTE_MUL(vLuma(src[i]), alpha) + cia;
+            dest[i] = BYTE_MUL(dest[i], a);
+        }
+    }
+}
+
+static void src_LumaOut(uint32_t *dest, int length, const uint32_t *src,
+                        uint32_t alpha)
+{
+    if (alpha == 255) {
+        for (int i = 0; i < length; ++i) {
+            dest[i] = BYTE_MUL(dest[i], 255 - vLuma(src[i]));
+        }
+    } else {
+        uint32_t cia = 255 - alpha;
+        for (int i = 0; i < length; ++i) {
+            uint32_t sia = BYTE_MUL(255 - vLuma(src[i]), alpha) + cia;
+            dest[i] = BYTE_MUL(dest[i], sia);
+        }
+    }
+}
+
 RenderFuncTable::RenderFuncTable()
 {
     updateColor(BlendMode::Src, color_Source);
     updateColor(BlendMode::SrcOver, color_SourceOver);
     updateColor(BlendMode::DestIn, color_DestinationIn);
     updateColor(BlendMode::DestOut, color_DestinationOut);
+    updateColor(BlendMode::LumaIn, color_LumaIn);
+    updateColor(BlendMode::LumaOut, color_LumaOut);
 
     updateSrc(BlendMode::Src, src_Source);
     updateSrc(BlendMode::SrcOver, src_SourceOver);
     updateSrc(BlendMode::DestIn, src_DestinationIn);
     updateSrc(BlendMode::DestOut, src_DestinationOut);
+    updateSrc(BlendMode::LumaIn, src_LumaIn);
+    updateSrc(BlendMode::LumaOut, src_LumaOut);
 
 #if defined(__ARM_NEON__)
     neon();
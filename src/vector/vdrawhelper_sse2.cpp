@@ -175,6 +175,232 @@ void memfill32(uint32_t* dest, uint32_t value, int length)
     }
 }
 
+void fetch_nearest_row(uint32_t* dest, const uint32_t* row, int x,
+                       int length, float sx, float offset, int left, int right)
+{
+    const __m128  v_sx = _mm_set1_ps(sx);
+    const __m128  v_offset = _mm_set1_ps(offset);
+    // clamping before the truncation picks the same texel as after it.
+    const __m128  v_left = _mm_set1_ps(float(left));
+    const __m128  v_right = _mm_set1_ps(float(right));
+    const __m128i v_four = _mm_set1_epi32(4);
+    __m128i       v_x = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+    alignas(16) int32_t px[4];
+
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        __m128 v_fx =
+            _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v_x), v_sx), v_offset);
+        v_fx = _mm_min_ps(_mm_max_ps(v_fx, v_left), v_right);
+        _mm_store_si128((__m128i*)px, _mm_cvttps_epi32(v_fx));
+        dest[i] = row[px[0]];
+        dest[i + 1] = row[px[1]];
+        dest[i + 2] = row[px[2]];
+        dest[i + 3] = row[px[3]];
+        v_x = _mm_add_epi32(v_x, v_four);
+    }
+    for (; i < length; i++) {
+        const int p = int(float(x + i) * sx + offset);
+        dest[i] = row[p < left ? left : p > right ? right : p];
+    }
+}
+
+void fetch_nearest(uint32_t* dest, const VTextureData& src, int x, int length,
+                   float sx, float ox, float sy, float oy)
+{
+    const __m128  v_sx = _mm_set1_ps(sx);
+    const __m128  v_ox = _mm_set1_ps(ox);
+    const __m128  v_sy = _mm_set1_ps(sy);
+    const __m128  v_oy = _mm_set1_ps(oy);
+    // clamped before the truncation, like fetch_nearest_row().
+    const __m128  v_left = _mm_set1_ps(float(src.left));
+    const __m128  v_right = _mm_set1_ps(float(src.right));
+    const __m128  v_top = _mm_set1_ps(float(src.top));
+    const __m128  v_bottom = _mm_set1_ps(float(src.bottom));
+    const __m128i v_four = _mm_set1_epi32(4);
+    __m128i       v_x = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+    alignas(16) int32_t px[4];
+    alignas(16) int32_t py[4];
+
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        const __m128 v_pos = _mm_cvtepi32_ps(v_x);
+        __m128       v_fx = _mm_add_ps(_mm_mul_ps(v_pos, v_sx), v_ox);
+        __m128       v_fy = _mm_add_ps(_mm_mul_ps(v_pos, v_sy), v_oy);
+        v_fx = _mm_min_ps(_mm_max_ps(v_fx, v_left), v_right);
+        v_fy = _mm_min_ps(_mm_max_ps(v_fy, v_top), v_bottom);
+        _mm_store_si128((__m128i*)px, _mm_cvttps_epi32(v_fx));
+        _mm_store_si128((__m128i*)py, _mm_cvttps_epi32(v_fy));
+        dest[i] = src.pixel(px[0], py[0]);
+        dest[i + 1] = src.pixel(px[1], py[1]);
+        dest[i + 2] = src.pixel(px[2], py[2]);
+        dest[i + 3] = src.pixel(px[3], py[3]);
+        v_x = _mm_add_epi32(v_x, v_four);
+    }
+    for (; i < length; i++) {
+        int fx = int(float(x + i) * sx + ox);
+        int fy = int(float(x + i) * sy + oy);
+        fx = fx < src.left ? src.left : fx > src.right ? src.right : fx;
+        fy = fy < src.top ? src.top : fy > src.bottom ? src.bottom : fy;
+        dest[i] = src.pixel(fx, fy);
+    }
+}
+
+// splits 24.8 positions into the first texel and the weight (0 - 256) of
+// the next one. the first texel is kept in [lo, hi - 1] so both can be
+// loaded together, at the edges the weight picks the clamped texel.
+static inline void bilinear_split_sse2(__m128i v, int lo, int hi,
+                                       __m128i& pos, __m128i& dist)
+{
+    const __m128i v_lo = _mm_set1_epi32(lo);
+    const __m128i v_hi = _mm_set1_epi32(hi - 1);
+    __m128i       p = _mm_srai_epi32(v, 8);
+    __m128i       d = _mm_and_si128(v, _mm_set1_epi32(0xff));
+    const __m128i below = _mm_cmplt_epi32(p, v_lo);
+    const __m128i above = _mm_cmpgt_epi32(p, v_hi);
+    const __m128i edge = _mm_or_si128(below, above);
+
+    p = _mm_or_si128(_mm_andnot_si128(edge, p),
+                     _mm_or_si128(_mm_and_si128(below, v_lo),
+                                  _mm_and_si128(above, v_hi)));
+    d = _mm_or_si128(_mm_andnot_si128(edge, d),
+                     _mm_and_si128(above, _mm_set1_epi32(256)));
+    pos = p;
+    dist = d;
+}
+
+// weights of two samples from 32bit lanes, each spread over the four
+// 16bit channels of its pixel.
+static inline __m128i bilinear_weights_sse2(__m128i dist)
+{
+    return _mm_or_si128(dist, _mm_slli_epi32(dist, 16));
+}
+
+// filters two samples from their top (tl, tr) and bottom (bl, br) texel
+// pairs, same math as interpolate_pixel() in 16bit lanes.
+static inline __m128i bilinear_pair_sse2(__m128i top0, __m128i top1,
+                                         __m128i bottom0, __m128i bottom1,
+                                         __m128i v_dx, __m128i v_dy)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v_256 = _mm_set1_epi16(256);
+    const __m128i v_idx = _mm_sub_epi16(v_256, v_dx);
+    const __m128i v_idy = _mm_sub_epi16(v_256, v_dy);
+
+    const __m128i t = _mm_unpacklo_epi32(top0, top1);
+    const __m128i b = _mm_unpacklo_epi32(bottom0, bottom1);
+    const __m128i top =
+        _mm_srli_epi16(_mm_add_epi16(
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(t, zero), v_idx),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(t, zero), v_dx)),
+                       8);
+    const __m128i bottom =
+        _mm_srli_epi16(_mm_add_epi16(
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), v_idx),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), v_dx)),
+                       8);
+    return _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(top, v_idy),
+                                        _mm_mullo_epi16(bottom, v_dy)),
+                          8);
+}
+
+void fetch_bilinear(uint32_t* dest, int length, const VTextureData& src,
+                    float fx, float fy, float fdx, float fdy)
+{
+    // one texel outside the clip is enough, the weights only need to
+    // reach the edge texels there.
+    const float xlo = float(src.left - 1), xhi = float(src.right + 1);
+    const float ylo = float(src.top - 1), yhi = float(src.bottom + 1);
+
+    if (src.right <= src.left || src.bottom <= src.top) {
+        // a single row or column, no texel pairs to load.
+        uint32_t texels[4], distx, disty;
+        for (int i = 0; i < length; i++) {
+            float px = fx + float(i) * fdx;
+            float py = fy + float(i) * fdy;
+            px = px < xlo ? xlo : px > xhi ? xhi : px;
+            py = py < ylo ? ylo : py > yhi ? yhi : py;
+            bilinear_texels(src, int(px * 256), int(py * 256), texels, distx,
+                            disty);
+            const uint32_t top =
+                interpolate_pixel(texels[0], 256 - distx, texels[1], distx);
+            const uint32_t bottom =
+                interpolate_pixel(texels[2], 256 - distx, texels[3], distx);
+            dest[i] = interpolate_pixel(top, 256 - disty, bottom, disty);
+        }
+        return;
+    }
+
+    const __m128 v_step = _mm_setr_ps(0, 1, 2, 3);
+    const __m128 v_256 = _mm_set1_ps(256);
+    const __m128 v_fx = _mm_set1_ps(fx);
+    const __m128 v_fdx = _mm_set1_ps(fdx);
+    const __m128 v_xlo = _mm_set1_ps(xlo);
+    const __m128 v_xhi = _mm_set1_ps(xhi);
+    const __m128 v_fy = _mm_set1_ps(fy);
+    const __m128 v_fdy = _mm_set1_ps(fdy);
+    const __m128 v_ylo = _mm_set1_ps(ylo);
+    const __m128 v_yhi = _mm_set1_ps(yhi);
+    // scale only, every sample of the span reads the same two rows.
+    const bool   scaleOnly = fdy == 0;
+    __m128i      v_y1, v_dy;
+    bilinear_split_sse2(_mm_cvttps_epi32(_mm_mul_ps(
+                            _mm_min_ps(_mm_max_ps(v_fy, v_ylo), v_yhi), v_256)),
+                        src.top, src.bottom, v_y1, v_dy);
+    alignas(16) int32_t x1[4], y1[4];
+    _mm_store_si128((__m128i*)y1, v_y1);
+    const uint32_t* r1 = src.pixelRef(0, y1[0]);
+    const uint32_t* r2 = src.pixelRef(0, y1[0] + 1);
+
+    for (int i = 0; i < length; i += 4) {
+        const __m128 v_i = _mm_add_ps(_mm_set1_ps(float(i)), v_step);
+        __m128       v_x = _mm_add_ps(v_fx, _mm_mul_ps(v_i, v_fdx));
+        v_x = _mm_min_ps(_mm_max_ps(v_x, v_xlo), v_xhi);
+        __m128i v_x1, v_dx;
+        bilinear_split_sse2(_mm_cvttps_epi32(_mm_mul_ps(v_x, v_256)),
+                            src.left, src.right, v_x1, v_dx);
+        _mm_store_si128((__m128i*)x1, v_x1);
+
+        __m128i top[4], bottom[4];
+        if (scaleOnly) {
+            for (int k = 0; k < 4; k++) {
+                top[k] = _mm_loadl_epi64((const __m128i*)(r1 + x1[k]));
+                bottom[k] = _mm_loadl_epi64((const __m128i*)(r2 + x1[k]));
+            }
+        } else {
+            __m128 v_y = _mm_add_ps(v_fy, _mm_mul_ps(v_i, v_fdy));
+            v_y = _mm_min_ps(_mm_max_ps(v_y, v_ylo), v_yhi);
+            bilinear_split_sse2(_mm_cvttps_epi32(_mm_mul_ps(v_y, v_256)),
+                                src.top, src.bottom, v_y1, v_dy);
+            _mm_store_si128((__m128i*)y1, v_y1);
+            for (int k = 0; k < 4; k++) {
+                const uint32_t* row = src.pixelRef(0, y1[k]);
+                top[k] = _mm_loadl_epi64((const __m128i*)(row + x1[k]));
+                row = src.pixelRef(0, y1[k] + 1);
+                bottom[k] = _mm_loadl_epi64((const __m128i*)(row + x1[k]));
+            }
+        }
+
+        const __m128i lo = bilinear_pair_sse2(
+            top[0], top[1], bottom[0], bottom[1],
+            bilinear_weights_sse2(_mm_unpacklo_epi32(v_dx, v_dx)),
+            bilinear_weights_sse2(_mm_unpacklo_epi32(v_dy, v_dy)));
+        const __m128i hi = bilinear_pair_sse2(
+            top[2], top[3], bottom[2], bottom[3],
+            bilinear_weights_sse2(_mm_unpackhi_epi32(v_dx, v_dx)),
+            bilinear_weights_sse2(_mm_unpackhi_epi32(v_dy, v_dy)));
+        const __m128i result = _mm_packus_epi16(lo, hi);
+
+        if (length - i >= 4) {
+            _mm_storeu_si128((__m128i*)(dest + i), result);
+        } else {
+            alignas(16) uint32_t tail[4];
+            _mm_store_si128((__m128i*)tail, result);
+            for (int k = 0; i + k < length; k++) dest[i + k] = tail[k];
+        }
+    }
+}
+
 // dest = color + (dest * alpha)
 inline static void copy_helper_sse2(uint32_t* dest, int length,
                                          uint32_t color, uint32_t alpha)
@@ -250,12 +476,91 @@ static void src_Source(uint32_t* dest, int length, const uint32_t* src,
     }
 }
 
+// vLuma() of 4 pixels, one per lane. Opaque and transparent pixels need
+// no un-premultiply, a block with any other alpha goes through the table.
+inline static __m128i v4_luma_sse2(const uint32_t* src)
+{
+    const __m128i v_mask = _mm_set1_epi32(0xFF);
+    const __m128i v_src = _mm_loadu_si128((const __m128i*)src);
+    const __m128i v_a = _mm_srli_epi32(v_src, 24);
+    const __m128i v_zero = _mm_cmpeq_epi32(v_a, _mm_setzero_si128());
+    const __m128i v_edge = _mm_or_si128(v_zero, _mm_cmpeq_epi32(v_a, v_mask));
+
+    if (_mm_movemask_epi8(v_edge) != 0xFFFF)
+        return _mm_set_epi32(int(vLuma(src[3])), int(vLuma(src[2])),
+                             int(vLuma(src[1])), int(vLuma(src[0])));
+
+    // channel * weight and the sum stay below 0x10000, so 16 bit lanes do.
+    __m128i v_r = _mm_and_si128(_mm_srli_epi32(v_src, 16), v_mask);
+    __m128i v_g = _mm_and_si128(_mm_srli_epi32(v_src, 8), v_mask);
+    __m128i v_b = _mm_and_si128(v_src, v_mask);
+    __m128i v_l = _mm_mullo_epi16(v_r, _mm_set1_epi32(77));
+    v_l = _mm_add_epi16(v_l, _mm_mullo_epi16(v_g, _mm_set1_epi32(150)));
+    v_l = _mm_add_epi16(v_l, _mm_mullo_epi16(v_b, _mm_set1_epi32(29)));
+    v_l = _mm_srli_epi32(_mm_add_epi16(v_l, _mm_set1_epi32(128)), 8);
+
+    return _mm_andnot_si128(v_zero, v_l);
+}
+
+// dest = dest * luma (or 255 - luma), fused so the matte buffer doesn't
+// need a separate conversion pass.
+inline static void luma_helper_sse2(uint32_t* dest, int length,
+                                    const uint32_t* src, uint32_t const_alpha,
+                                    bool invert)
+{
+    const __m128i v_255 = _mm_set1_epi32(255);
+    const __m128i v_ca = _mm_set1_epi32(const_alpha);
+    const __m128i v_cia = _mm_set1_epi32(255 - const_alpha);
+
+    LOOP_ALIGNED_U1_A4(dest, length,
+                       { /* UOP */
+                         uint32_t a = vLuma(*src);
+                         if (invert) a = 255 - a;
+                         if (const_alpha != 255)
+                             a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+                         *dest = BYTE_MUL(*dest, a);
+                         dest++;
+                         src++;
+                         length--;
+                       },
+                       { /* A4OP */
+                         __m128i v_a = v4_luma_sse2(src);
+                         if (invert) v_a = _mm_sub_epi32(v_255, v_a);
+                         if (const_alpha != 255) {
+                             // BYTE_MUL(a, const_alpha) + 255 - const_alpha
+                             v_a = v4_byte_mul_sse2(v_a, v_ca);
+                             v_a = _mm_add_epi32(v_a, v_cia);
+                         }
+                         v_a = _mm_or_si128(v_a, _mm_slli_epi32(v_a, 16));
+
+                         __m128i v_dest = _mm_load_si128((__m128i*)dest);
+                         v_dest = v4_byte_mul_sse2(v_dest, v_a);
+                         _mm_store_si128((__m128i*)dest, v_dest);
+
+                         V4_SRC_DEST_LEN_INC
+                       })
+}
+
+static void src_LumaIn(uint32_t* dest, int length, const uint32_t* src,
+                       uint32_t const_alpha)
+{
+    luma_helper_sse2(dest, length, src, const_alpha, false);
+}
+
+static void src_LumaOut(uint32_t* dest, int length, const uint32_t* src,
+                        uint32_t const_alpha)
+{
+    luma_helper_sse2(dest, length, src, const_alpha, true);
+}
+
 void RenderFuncTable::sse()
 {
     updateColor(BlendMode::Src , color_Source);
     updateColor(BlendMode::SrcOver , color_SourceOver);
 
     updateSrc(BlendMode::Src , src_Source);
+    updateSrc(BlendMode::LumaIn , src_LumaIn);
+    updateSrc(BlendMode::LumaOut , src_LumaOut);
 }
 
 #endif
@@ -288,6 +288,8 @@ enum class BlendMode {
     SrcOver,
     DestIn,
     DestOut,
+    LumaIn,   // DestIn / DestOut with the source luminance as its alpha
+    LumaOut,
     Last,
 };
 
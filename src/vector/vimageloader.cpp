@@ -118,8 +118,9 @@ struct VImageLoader::Impl {
                          int channel)
     {
         // premultiply alpha
+        bool opaque = (channel == 1 || channel == 3);
         if (channel == 4)
-            convertToBGRAPremul(data, width, height);
+            opaque = convertToBGRAPremul(data, width, height);
         else
             convertToBGRA(data, width, height);
 
@@ -129,6 +130,8 @@ struct VImageLoader::Impl {
 
         // copy the data to bitmap buffer
         memcpy(result.data(), data, width * height * 4);
+        result.addDirtyRect(result.rect());
+        result.setOpaque(opaque);
 
         // free the image data
         imageFree(data);
@@ -165,17 +168,20 @@ struct VImageLoader::Impl {
         return createBitmap(data, width, height, n);
     }
     /*
-     * convert from RGBA to BGRA and premultiply
+     * convert from RGBA to BGRA and premultiply, returns true if no pixel
+     * is translucent.
      */
-    void convertToBGRAPremul(unsigned char *bits, int width, int height)
+    bool convertToBGRAPremul(unsigned char *bits, int width, int height)
     {
         int            pixelCount = width * height;
         unsigned char *pix = bits;
+        unsigned char  alpha = 255;
         for (int i = 0; i < pixelCount; i++) {
             unsigned char r = pix[0];
             unsigned char g = pix[1];
             unsigned char b = pix[2];
             unsigned char a = pix[3];
+            alpha &= a;
 
             r = (r * a) / 255;
             g = (g * a) / 255;
@@ -187,6 +193,7 @@ struct VImageLoader::Impl {
 
             pix += 4;
         }
+        return alpha == 255;
     }
     /*
      * convert from RGBA to BGRA
@@ -218,3 +225,65 @@ VBitmap VImageLoader::load(const char *data, size_t len)
 {
     return mImpl->load(data, int(len));
 }
+
+bool VImageCache::find(const std::string &key, VBitmap &result)
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    auto search = mHash.find(key);
+    if (search == mHash.end()) return false;
+
+    mLru.splice(mLru.begin(), mLru, search->second.mLru);
+    result = search->second.mBitmap;
+    return true;
+}
+
+VBitmap VImageCache::add(const std::string &key, const VBitmap &bitmap)
+{
+    if (!bitmap.valid()) return bitmap;
+
+    size_t bytes = bitmap.stride() * bitmap.height();
+
+    std::lock_guard<std::mutex> guard(mMutex);
+
+    auto search = mHash.find(key);
+    if (search != mHash.end()) return search->second.mBitmap;
+
+    if (!mBudget || bytes > mBudget) return bitmap;
+
+    trim(mBudget - bytes);
+
+    mLru.push_front(key);
+    mHash[key] = Entry{bitmap, bytes, mLru.begin()};
+    mBytes += bytes;
+    return bitmap;
+}
+
+void VImageCache::setBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+    mBudget = bytes;
+    trim(mBudget);
+    if (!mBudget) {
+        mHash.clear();
+        mLru.clear();
+    }
+}
+
+void VImageCache::purge()
+{
+    std::lock_guard<std::mutex> guard(mMutex);
+    mHash.clear();
+    mLru.clear();
+    mBytes = 0;
+}
+
+void VImageCache::trim(size_t budget)
+{
+    while (mBytes > budget && !mLru.empty()) {
+        auto search = mHash.find(mLru.back());
+        mBytes -= search->second.mBytes;
+        mHash.erase(search);
+        mLru.pop_back();
+    }
+}
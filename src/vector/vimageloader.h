@@ -1,7 +1,11 @@
 #ifndef VIMAGELOADER_H
 #define VIMAGELOADER_H
 
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "vbitmap.h"
 
@@ -23,4 +27,43 @@ private:
     std::unique_ptr<Impl> mImpl;
 };
 
+/*
+ * Decoded images shared by all the animations, keyed by the image path or
+ * by a hash of the encoded content. Least recently used entries are
+ * dropped once the decoded pixels exceed the byte budget.
+ */
+class VImageCache
+{
+public:
+    static VImageCache& instance()
+    {
+         static VImageCache singleton;
+         return singleton;
+    }
+
+    bool    find(const std::string &key, VBitmap &result);
+    // returns the cached entry when another thread added the key first,
+    // invalid bitmaps are not cached.
+    VBitmap add(const std::string &key, const VBitmap &bitmap);
+    // 0 disables the cache and drops all the entries.
+    void    setBudget(size_t bytes);
+    // drops all the entries, pixels still referenced by an animation are
+    // released when it lets go of them.
+    void    purge();
+private:
+    VImageCache() = default;
+    void    trim(size_t budget);
+
+    struct Entry {
+        VBitmap                          mBitmap;
+        size_t                           mBytes{0};
+        std::list<std::string>::iterator mLru;
+    };
+    std::unordered_map<std::string, Entry> mHash;
+    std::list<std::string>                 mLru;  // most recent first
+    std::mutex                             mMutex;
+    size_t                                 mBudget{64 * 1024 * 1024};
+    size_t                                 mBytes{0};
+};
+
 #endif // VIMAGELOADER_H
@@ -5,6 +5,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "vinterpolator.h"
+#include <atomic>
 #include <cmath>
 
 V_BEGIN_NAMESPACE
@@ -17,14 +18,37 @@ V_BEGIN_NAMESPACE
 const float VInterpolator::kSampleStepSize =
     1.0f / float(VInterpolator::kSplineTableSize - 1);
 
+static std::atomic<VInterpolator::Mode> InterpolatorMode{
+    VInterpolator::Mode::Exact};
+
+void VInterpolator::setMode(Mode mode)
+{
+    InterpolatorMode.store(mode, std::memory_order_relaxed);
+}
+
+VInterpolator::Mode VInterpolator::mode()
+{
+    return InterpolatorMode.load(std::memory_order_relaxed);
+}
+
 void VInterpolator::init(float aX1, float aY1, float aX2, float aY2)
 {
     mX1 = aX1;
     mY1 = aY1;
     mX2 = aX2;
     mY2 = aY2;
+    mLookupTable.reset();
+
+    if (mX1 == mY1 && mX2 == mY2) return;
+
+    CalcSampleValues();
 
-    if (mX1 != mY1 || mX2 != mY2) CalcSampleValues();
+    if (mode() == Mode::Table) {
+        std::unique_ptr<float[]> table(new float[kLookupTableSize + 1]);
+        for (int i = 0; i <= kLookupTableSize; ++i)
+            table[i] = value(float(i) / kLookupTableSize);
+        mLookupTable = std::move(table);
+    }
 }
 
 /*static*/ float VInterpolator::CalcBezier(float aT, float aA1, float aA2)
@@ -49,6 +73,16 @@ float VInterpolator::value(float aX) const
 {
     if (mX1 == mY1 && mX2 == mY2) return aX;
 
+    if (mLookupTable) {
+        float pos = aX * kLookupTableSize;
+        if (pos <= 0) return mLookupTable[0];
+        if (pos >= kLookupTableSize) return mLookupTable[kLookupTableSize];
+        int   index = int(pos);
+        float frac = pos - index;
+        return mLookupTable[index] +
+               frac * (mLookupTable[index + 1] - mLookupTable[index]);
+    }
+
     return CalcBezier(GetTForX(aX), mY1, mY2);
 }
 
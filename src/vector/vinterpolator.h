@@ -23,12 +23,23 @@
 #ifndef VINTERPOLATOR_H
 #define VINTERPOLATOR_H
 
+#include <memory>
 #include "vpoint.h"
 
 V_BEGIN_NAMESPACE
 
 class VInterpolator {
 public:
+    /*
+     * Table mode samples the curve into kLookupTableSize + 1 values at
+     * init() time and value() becomes a linear interpolation between two
+     * of them instead of a Newton-Raphson / bisection solve. Only affects
+     * interpolators initialized after the mode is changed.
+     */
+    enum class Mode { Exact, Table };
+    static void setMode(Mode mode);
+    static Mode mode();
+
     VInterpolator()
     { /* caller must call Init later */
     }
@@ -81,6 +92,8 @@ private:
     enum { kSplineTableSize = 11 };
     float              mSampleValues[kSplineTableSize];
     static const float kSampleStepSize;
+    enum { kLookupTableSize = 256 };
+    std::unique_ptr<float[]> mLookupTable;
 };
 
 V_END_NAMESPACE
@@ -41,6 +41,13 @@ public:
         Project = 0x10
     };
     VMatrix() = default;
+    // type must be the one type() reports for these elements
+    VMatrix(float m11, float m12, float m13, float m21, float m22, float m23,
+            float mtx, float mty, float m33, MatrixType type)
+        : m11(m11), m12(m12), m13(m13), m21(m21), m22(m22), m23(m23),
+          mtx(mtx), mty(mty), m33(m33), mType(type)
+    {
+    }
     bool         isAffine() const;
     bool         isIdentity() const;
     bool         isInvertible() const;
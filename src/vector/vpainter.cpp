@@ -37,6 +37,7 @@ void VPainter::drawRle(const VPoint &, const VRle &rle)
     // do draw after applying clip.
     rle.intersect(mSpanData.clipRect(), mSpanData.mUnclippedBlendFunc,
                   &mSpanData);
+    markDirty(rle.boundingRect());
 }
 
 void VPainter::drawRle(const VRle &rle, const VRle &clip)
@@ -45,17 +46,29 @@ void VPainter::drawRle(const VRle &rle, const VRle &clip)
 
     if (!mSpanData.mUnclippedBlendFunc) return;
 
-    rle.intersect(clip, mSpanData.mUnclippedBlendFunc, &mSpanData);
+    // the intersection lies inside both, only an offscreen buffer
+    // smaller than the canvas needs the extra clip.
+    auto bounds = mSpanData.clipRect();
+    if (bounds.contains(rle.boundingRect()) ||
+        bounds.contains(clip.boundingRect())) {
+        rle.intersect(clip, mSpanData.mUnclippedBlendFunc, &mSpanData);
+    } else {
+        (rle & clip).intersect(bounds, mSpanData.mUnclippedBlendFunc,
+                               &mSpanData);
+    }
+    markDirty(rle.boundingRect() & clip.boundingRect());
 }
 
-static void fillRect(const VRect &r, VSpanData *data)
+// returns the filled area.
+static VRect fillRect(const VRect &r, VSpanData *data)
 {
-    auto x1 = std::max(r.x(), 0);
-    auto x2 = std::min(r.x() + r.width(), data->mDrawableSize.width());
-    auto y1 = std::max(r.y(), 0);
-    auto y2 = std::min(r.y() + r.height(), data->mDrawableSize.height());
+    auto bounds = data->clipRect();
+    auto x1 = std::max(r.x(), bounds.x());
+    auto x2 = std::min(r.x() + r.width(), bounds.right());
+    auto y1 = std::max(r.y(), bounds.y());
+    auto y2 = std::min(r.y() + r.height(), bounds.bottom());
 
-    if (x2 <= x1 || y2 <= y1) return;
+    if (x2 <= x1 || y2 <= y1) return {};
 
     const int  nspans = 256;
     VRle::Span spans[nspans];
@@ -75,6 +88,7 @@ static void fillRect(const VRect &r, VSpanData *data)
         data->mUnclippedBlendFunc(n, spans, data);
         y += n;
     }
+    return VRect(x1, y1, x2 - x1, y2 - y1);
 }
 
 void VPainter::drawBitmapUntransform(const VRect &  target,
@@ -85,11 +99,12 @@ void VPainter::drawBitmapUntransform(const VRect &  target,
     mSpanData.initTexture(&bitmap, const_alpha, source);
     if (!mSpanData.mUnclippedBlendFunc) return;
 
-    // update translation matrix for source texture.
-    mSpanData.dx = float(target.x() - source.x());
-    mSpanData.dy = float(target.y() - source.y());
+    // update translation matrix for source texture, the blend function
+    // reads the texture at span + (dx, dy).
+    mSpanData.dx = float(source.x() - target.x());
+    mSpanData.dy = float(source.y() - target.y());
 
-    fillRect(target, &mSpanData);
+    markDirty(fillRect(target, &mSpanData));
 }
 
 VPainter::VPainter(VBitmap *buffer)
@@ -98,14 +113,32 @@ VPainter::VPainter(VBitmap *buffer)
 }
 bool VPainter::begin(VBitmap *buffer)
 {
+    mBitmap = buffer;
     mBuffer.prepare(buffer);
     mSpanData.init(&mBuffer);
-    // TODO find a better api to clear the surface
-    mBuffer.clear();
+    // only the area drawn by the previous user of the buffer needs a clear,
+    // recycled offscreen surfaces are mostly clean already.
+    buffer->clearDirty();
+    return true;
+}
+bool VPainter::begin(VBitmap *buffer, const VPoint &origin)
+{
+    begin(buffer);
+    mSpanData.setOrigin(origin);
     return true;
 }
 void VPainter::end() {}
 
+void VPainter::markDirty(const VRect &rect)
+{
+    if (!mBitmap || rect.empty()) return;
+
+    // canvas to buffer coordinates.
+    VRect area = rect & mSpanData.clipRect();
+    mBitmap->addDirtyRect(area.translated(mSpanData.mOffset.x(),
+                                          mSpanData.mOffset.y()));
+}
+
 void VPainter::setDrawRegion(const VRect &region)
 {
     mSpanData.setDrawRegion(region);
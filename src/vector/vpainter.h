@@ -36,6 +36,8 @@ public:
     VPainter() = default;
     explicit VPainter(VBitmap *buffer);
     bool  begin(VBitmap *buffer);
+    // buffer covers the canvas area at origin, see VSpanData::setOrigin()
+    bool  begin(VBitmap *buffer, const VPoint &origin);
     void  end();
     void  setDrawRegion(const VRect &region); // sub surface rendering area.
     void  setBrush(const VBrush &brush);
@@ -51,6 +53,9 @@ public:
 private:
     void drawBitmapUntransform(const VRect &target, const VBitmap &bitmap,
                                const VRect &source, uint8_t const_alpha);
+    // records the canvas area written by a draw call.
+    void markDirty(const VRect &rect);
+    VBitmap *     mBitmap{nullptr};
     VRasterBuffer mBuffer;
     VSpanData     mSpanData;
 };
@@ -22,6 +22,7 @@
 
 #ifndef VPATH_H
 #define VPATH_H
+#include <cstring>
 #include <vector>
 #include "vcowptr.h"
 #include "vmatrix.h"
@@ -73,6 +74,8 @@ public:
     const std::vector<VPath::Element> &elements() const;
     const std::vector<VPointF> &       points() const;
     void  clone(const VPath &srcPath);
+    bool  operator==(const VPath &o) const;
+    bool  operator!=(const VPath &o) const { return !(*this == o); }
     bool unique() const { return d.unique();}
     size_t refCount() const { return d.refCount();}
 
@@ -280,6 +283,22 @@ inline void VPath::clone(const VPath &o)
    d.write().clone(o.d.read());
 }
 
+// exact comparison of the elements and points.
+inline bool VPath::operator==(const VPath &o) const
+{
+    if (&d.read() == &o.d.read()) return true;
+
+    const auto &elms = elements();
+    const auto &pts = points();
+    if (elms.size() != o.elements().size() || pts.size() != o.points().size())
+        return false;
+
+    return !std::memcmp(elms.data(), o.elements().data(),
+                        elms.size() * sizeof(VPath::Element)) &&
+           !std::memcmp(pts.data(), o.points().data(),
+                        pts.size() * sizeof(VPointF));
+}
+
 V_END_NAMESPACE
 
 #endif  // VPATH_H
@@ -21,17 +21,127 @@
  */
 
 #include "vpathmesure.h"
-#include <limits>
+#include <algorithm>
 #include "vbezier.h"
-#include "vdasher.h"
+#include "vline.h"
 
 V_BEGIN_NAMESPACE
 
+// pieces shorter than this at the ends of a range are dropped (as VDasher does)
+static constexpr float tolerance = 0.1f;
+
+void VPathMesure::updateLengths(const VPath &path)
+{
+    const std::vector<VPath::Element> &elms = path.elements();
+    const std::vector<VPointF> &       pts = path.points();
+
+    mSource.clone(path);
+    mLengths.resize(elms.size());
+    mPoints.resize(elms.size());
+    mContours.clear();
+    mLength = 0.0f;
+
+    size_t index = 0;
+    float  length = 0.0f;
+    for (size_t i = 0; i < elms.size(); i++) {
+        mPoints[i] = uint32_t(index);
+        switch (elms[i]) {
+        case VPath::Element::MoveTo:
+            if (!mContours.empty()) mContours.back().mEnd = i;
+            mContours.push_back({i, elms.size()});
+            length = 0.0f;
+            index++;
+            break;
+        case VPath::Element::LineTo: {
+            float len = VLine(pts[index - 1], pts[index]).length();
+            length += len;
+            mLength += len;
+            index++;
+            break;
+        }
+        case VPath::Element::CubicTo: {
+            float len = VBezier::fromPoints(pts[index - 1], pts[index],
+                                            pts[index + 1], pts[index + 2])
+                            .length();
+            length += len;
+            mLength += len;
+            index += 3;
+            break;
+        }
+        case VPath::Element::Close:
+            break;
+        }
+        mLengths[i] = length;
+    }
+}
+
+/*
+ * Appends the part of the contour between the arc lengths from and to.
+ * The segment holding from is found by a binary search on the length
+ * table, only the first and the last segment of the range get split.
+ */
+void VPathMesure::addRange(const VPath &path, const Contour &contour,
+                           float from, float to)
+{
+    const std::vector<VPath::Element> &elms = path.elements();
+    const std::vector<VPointF> &       pts = path.points();
+
+    to = std::min(to, mLengths[contour.mEnd - 1]);
+    if (from >= to) return;
+
+    auto first = std::upper_bound(mLengths.begin() + contour.mElement + 1,
+                                  mLengths.begin() + contour.mEnd, from);
+
+    bool started = false;
+    for (size_t i = first - mLengths.begin(); i < contour.mEnd; i++) {
+        float segStart = mLengths[i - 1];
+        float segEnd = mLengths[i];
+
+        if (segStart >= to) break;
+        if (segEnd <= segStart) continue;
+
+        float len = segEnd - segStart;
+        float l0 = std::max(from, segStart) - segStart;
+        float l1 = std::min(to, segEnd) - segStart;
+        bool  whole = l0 <= 0 && l1 >= len;
+
+        // skip slivers at the ends unless the range is inside this segment
+        if (!whole && l1 - l0 < tolerance && (from < segStart || to > segEnd))
+            continue;
+
+        size_t p = mPoints[i];
+        if (elms[i] == VPath::Element::LineTo) {
+            VLine line(pts[p - 1], pts[p]);
+            VPointF s = line.p1();
+            VPointF e = line.p2();
+            if (!whole) {
+                s = line.p1() + (line.p2() - line.p1()) * (l0 / len);
+                e = line.p1() + (line.p2() - line.p1()) * (l1 / len);
+            }
+            if (!started) mScratchObject.moveTo(s);
+            mScratchObject.lineTo(e);
+        } else {
+            VBezier b = VBezier::fromPoints(pts[p - 1], pts[p], pts[p + 1],
+                                            pts[p + 2]);
+            if (!whole) {
+                float t0 = l0 > 0 ? b.tAtLength(l0, len) : 0.0f;
+                float t1 = l1 < len ? b.tAtLength(l1, len) : 1.0f;
+                if (t0 >= t1) continue;
+                b = b.onInterval(t0, t1);
+            }
+            if (!started) mScratchObject.moveTo(b.pt1());
+            mScratchObject.cubicTo(b.pt2(), b.pt3(), b.pt4());
+        }
+        started = true;
+    }
+}
+
 /*
  * start and end value must be normalized to [0 - 1]
  * Path mesure trims the path from [start --> end]
  * if start > end it treates as a loop and trims as two segment
  *  [0-->end] and [start --> 1]
+ * Every contour is trimmed with the lengths of the whole path.
  */
 VPath VPathMesure::trim(const VPath &path)
 {
@@ -41,27 +151,21 @@ VPath VPathMesure::trim(const VPath &path)
         (vCompare(mStart, 1.0f) && (vCompare(mEnd, 0.0f))))
         return path;
 
-    float length = path.length();
-
-    if (mStart < mEnd) {
-        float array[4] = {
-            0.0f, length * mStart,  // 1st segment
-            (mEnd - mStart) * length,
-            std::numeric_limits<float>::max(),  // 2nd segment
-        };
-        VDasher dasher(array, 4);
-        dasher.dashed(path, mScratchObject);
-        return mScratchObject;
-    } else {
-        float array[4] = {
-            length * mEnd, (mStart - mEnd) * length,  // 1st segment
-            (1 - mStart) * length,
-            std::numeric_limits<float>::max(),  // 2nd segment
-        };
-        VDasher dasher(array, 4);
-        dasher.dashed(path, mScratchObject);
-        return mScratchObject;
+    if (mSource != path) updateLengths(path);
+
+    mScratchObject.reset();
+    mScratchObject.reserve(path.points().size(), path.elements().size());
+
+    for (const auto &contour : mContours) {
+        if (mStart < mEnd) {
+            addRange(path, contour, mLength * mStart, mLength * mEnd);
+        } else {
+            addRange(path, contour, 0.0f, mLength * mEnd);
+            addRange(path, contour, mLength * mStart, mLength);
+        }
     }
+
+    return mScratchObject;
 }
 
 V_END_NAMESPACE
@@ -23,6 +23,7 @@
 #ifndef VPATHMESURE_H
 #define VPATHMESURE_H
 
+#include <vector>
 #include "vpath.h"
 
 V_BEGIN_NAMESPACE
@@ -34,9 +35,25 @@ public:
     void  setEnd(float end){mEnd = end;}
     VPath trim(const VPath &path);
 private:
+    struct Contour {
+        size_t mElement;  // index of the MoveTo element
+        size_t mEnd;      // one past the last element
+    };
+    void  updateLengths(const VPath &path);
+    void  addRange(const VPath &path, const Contour &contour, float from,
+                   float to);
+
     float mStart{0.0f};
     float mEnd{1.0f};
     VPath mScratchObject;
+
+    // arc length table of the last trimmed path, only rebuilt when the
+    // path changes so that animating start/end doesn't measure it again.
+    VPath                 mSource;
+    std::vector<float>    mLengths;  // contour length at the end of each element
+    std::vector<uint32_t> mPoints;   // index of the first point of each element
+    std::vector<Contour>  mContours;
+    float                 mLength{0.0f};
 };
 
 V_END_NAMESPACE
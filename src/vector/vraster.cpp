@@ -20,15 +20,18 @@
  * SOFTWARE.
  */
 #include "vraster.h"
+#include <atomic>
 #include <climits>
 #include <cstring>
 #include <memory>
 #include "config.h"
+#include "vdasher.h"
 #include "v_ft_raster.h"
 #include "v_ft_stroker.h"
 #include "vdebug.h"
 #include "vmatrix.h"
 #include "vpath.h"
+#include "vrasteraccum.h"
 #include "vrle.h"
 
 V_BEGIN_NAMESPACE
@@ -311,38 +314,111 @@ private:
     bool                    _pending{false};
 };
 
+#ifdef LOTTIE_ACCUM_RASTER_SUPPORT
+static std::atomic<VRasterizer::Backend> RasterBackend{
+    VRasterizer::Backend::Accumulation};
+#else
+static std::atomic<VRasterizer::Backend> RasterBackend{
+    VRasterizer::Backend::Gray};
+#endif
+
+void VRasterizer::setBackend(Backend backend)
+{
+    RasterBackend.store(backend, std::memory_order_relaxed);
+}
+
+VRasterizer::Backend VRasterizer::backend()
+{
+    return RasterBackend.load(std::memory_order_relaxed);
+}
+
+/*
+ * Dashed copy of the last stroked path. Strokes whose path and dash
+ * pattern stay the same between frames (animated width, static dashed
+ * shapes) don't need to be dashed again. The source path is only
+ * remembered by a hash of its elements and points, no copy is kept.
+ */
+struct DashCache {
+    uint64_t           mSourceHash{0};
+    std::vector<float> mPattern;
+    VPath              mDashed;
+
+    // 64 bit FNV-1a
+    static uint64_t hash(const void *data, size_t bytes, uint64_t h)
+    {
+        auto *p = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < bytes; i++) {
+            h ^= p[i];
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    static uint64_t hash(const VPath &path)
+    {
+        const auto &elms = path.elements();
+        const auto &pts = path.points();
+        uint64_t    h = 0xcbf29ce484222325ULL;
+        h = hash(elms.data(), elms.size() * sizeof(VPath::Element), h);
+        return hash(pts.data(), pts.size() * sizeof(VPointF), h);
+    }
+
+    const VPath &dashed(const VPath &path, const std::vector<float> &pattern)
+    {
+        uint64_t sourceHash = hash(path);
+        if (mPattern != pattern || mSourceHash != sourceHash) {
+            VDasher dasher(pattern.data(), pattern.size());
+            dasher.dashed(path, mDashed);
+            mSourceHash = sourceHash;
+            mPattern = pattern;
+        }
+        return mDashed;
+    }
+};
+
 struct VRleTask {
     SharedRle mRle;
     VPath     mPath;
     float     mStrokeWidth;
     float     mMiterLimit;
     VRect     mClip;
+    float     mFlatness;
     FillRule  mFillRule;
     CapStyle  mCap;
     JoinStyle mJoin;
     bool      mGenerateStroke;
+    std::vector<float> mDash;
+    DashCache          mDashCache;
 
     VRle &rle() { return mRle.get(); }
 
-    void update(VPath path, FillRule fillRule, const VRect &clip)
+    void update(VPath path, FillRule fillRule, const VRect &clip,
+                float flatness)
     {
         mRle.reset();
         mPath = std::move(path);
         mFillRule = fillRule;
         mClip = clip;
+        mFlatness = flatness;
         mGenerateStroke = false;
     }
 
     void update(VPath path, CapStyle cap, JoinStyle join, float width,
-                float miterLimit, const VRect &clip)
+                float miterLimit, const std::vector<float> *dash,
+                const VRect &clip, float flatness)
     {
         mRle.reset();
         mPath = std::move(path);
+        if (dash)
+            mDash = *dash;
+        else
+            mDash.clear();
         mCap = cap;
         mJoin = join;
         mStrokeWidth = width;
         mMiterLimit = miterLimit;
         mClip = clip;
+        mFlatness = flatness;
         mGenerateStroke = true;
     }
     void render(FTOutline &outRef)
@@ -351,11 +427,16 @@ struct VRleTask {
 
         mRle.unsafe().reset();
 
+        if (VRasterizer::backend() == VRasterizer::Backend::Accumulation &&
+            vRasterAccumulate(outRef.ft, mClip, mFlatness, mRle.unsafe()))
+            return;
+
         params.flags = SW_FT_RASTER_FLAG_DIRECT | SW_FT_RASTER_FLAG_AA;
         params.gray_spans = &rleGenerationCb;
         params.bbox_cb = &bboxCb;
         params.user = &mRle.unsafe();
         params.source = &outRef.ft;
+        params.flatness = SW_FT_Pos(mFlatness * 64);
 
         if (!mClip.empty()) {
             params.flags |= SW_FT_RASTER_FLAG_CLIP;
@@ -377,7 +458,8 @@ struct VRleTask {
         }
 
         if (mGenerateStroke) {  // Stroke Task
-            outRef.convert(mPath);
+            outRef.convert(mDash.empty() ? mPath
+                                         : mDashCache.dashed(mPath, mDash));
             outRef.convert(mCap, mJoin, mStrokeWidth, mMiterLimit);
 
             uint32_t points, contors;
@@ -564,26 +646,44 @@ void VRasterizer::updateRequest()
     RleTaskScheduler::instance().process(std::move(taskObj));
 }
 
-void VRasterizer::rasterize(VPath path, FillRule fillRule, const VRect &clip)
+void VRasterizer::rasterize(VPath path, FillRule fillRule, const VRect &clip,
+                            float flatness)
 {
     init();
     if (path.empty()) {
         d->rle().reset();
         return;
     }
-    d->task().update(std::move(path), fillRule, clip);
+    d->task().update(std::move(path), fillRule, clip, flatness);
+    updateRequest();
+}
+
+void VRasterizer::rasterize(VPath path, CapStyle cap, JoinStyle join,
+                            float width, float miterLimit, const VRect &clip,
+                            float flatness)
+{
+    init();
+    if (path.empty() || vIsZero(width)) {
+        d->rle().reset();
+        return;
+    }
+    d->task().update(std::move(path), cap, join, width, miterLimit, nullptr,
+                     clip, flatness);
     updateRequest();
 }
 
 void VRasterizer::rasterize(VPath path, CapStyle cap, JoinStyle join,
-                            float width, float miterLimit, const VRect &clip)
+                            float width, float miterLimit,
+                            const std::vector<float> &dash, const VRect &clip,
+                            float flatness)
 {
     init();
     if (path.empty() || vIsZero(width)) {
         d->rle().reset();
         return;
     }
-    d->task().update(std::move(path), cap, join, width, miterLimit, clip);
+    d->task().update(std::move(path), cap, join, width, miterLimit, &dash,
+                     clip, flatness);
     updateRequest();
 }
 
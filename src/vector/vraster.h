@@ -23,6 +23,7 @@
 #ifndef VRASTER_H
 #define VRASTER_H
 #include <future>
+#include <vector>
 #include "vglobal.h"
 #include "vrect.h"
 
@@ -34,9 +35,28 @@ class VRle;
 class VRasterizer
 {
 public:
-    void rasterize(VPath path, FillRule fillRule = FillRule::Winding, const VRect &clip = VRect());
+    enum class Backend {
+        Gray,         // freetype gray raster (cell list)
+        Accumulation  // signed area accumulation buffer
+    };
+    static void    setBackend(Backend backend);
+    static Backend backend();
+
+    // maximum distance in pixels between a curve and its flattened lines.
+    static constexpr float DefaultFlatness = 0.5f;
+
+    void rasterize(VPath path, FillRule fillRule = FillRule::Winding,
+                   const VRect &clip = VRect(),
+                   float flatness = DefaultFlatness);
+    void rasterize(VPath path, CapStyle cap, JoinStyle join, float width,
+                   float miterLimit, const VRect &clip = VRect(),
+                   float flatness = DefaultFlatness);
+    // dashes the path in the raster task, the dashed path is kept and
+    // reused as long as the path and the dash pattern don't change.
     void rasterize(VPath path, CapStyle cap, JoinStyle join, float width,
-                   float miterLimit, const VRect &clip = VRect());
+                   float miterLimit, const std::vector<float> &dash,
+                   const VRect &clip = VRect(),
+                   float flatness = DefaultFlatness);
     VRle rle();
 private:
     struct VRasterizerImpl;
@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vrasteraccum.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include "vpoint.h"
+#include "vrle.h"
+
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+V_BEGIN_NAMESPACE
+
+// upper limit of accumulation cells, bigger outlines go to the gray raster.
+static constexpr size_t MaxAccumCells = 4096 * 4096;
+
+// max subdivision depth of a single curve.
+static constexpr int MaxCurveLevel = 16;
+
+static inline int lowestBit(uint64_t word)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return int(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+/*
+ * Accumulation buffer is reused across the calls.
+ * Invariant: all the cells, touch bits and row ranges are cleared
+ * between two render calls, the sweep restores it for the touched
+ * cells only.
+ */
+struct AccumBuffer {
+    std::vector<float>    mCells;
+    std::vector<uint64_t> mTouched;
+    std::vector<int>      mMinX;
+    std::vector<int>      mMaxX;
+
+    void reserve(size_t cells, size_t words, size_t rows)
+    {
+        if (mCells.size() < cells) mCells.resize(cells, 0.0f);
+        if (mTouched.size() < words) mTouched.resize(words, 0);
+        if (mMinX.size() < rows) {
+            mMinX.resize(rows, INT_MAX);
+            mMaxX.resize(rows, -1);
+        }
+    }
+};
+
+static vthread_local AccumBuffer Accum_Buffer;
+
+class AccumRaster {
+public:
+    AccumRaster(AccumBuffer &buffer, const VRect &region, bool evenOdd,
+                float flatness)
+        : mOrigin(region.left(), region.top()),
+          mWidth(region.width()),
+          mHeight(region.height()),
+          mStride(region.width() + 2),
+          mWordStride((mStride + 63) / 64),
+          mEvenOdd(evenOdd),
+          mCubicFlat(flatness),
+          mConicFlat(flatness / 2)
+    {
+        buffer.reserve(size_t(mStride) * mHeight,
+                       size_t(mWordStride) * mHeight, mHeight);
+        mCells = buffer.mCells.data();
+        mTouched = buffer.mTouched.data();
+        mMinX = buffer.mMinX.data();
+        mMaxX = buffer.mMaxX.data();
+    }
+
+    void moveTo(const SW_FT_Vector &pt) { mStart = mCurrent = toPoint(pt); }
+    void lineTo(const SW_FT_Vector &pt)
+    {
+        VPointF to = toPoint(pt);
+        line(mCurrent, to);
+        mCurrent = to;
+    }
+    void conicTo(const SW_FT_Vector &ctrl, const SW_FT_Vector &pt);
+    void cubicTo(const SW_FT_Vector &ctrl1, const SW_FT_Vector &ctrl2,
+                 const SW_FT_Vector &pt);
+    void close()
+    {
+        line(mCurrent, mStart);
+        mCurrent = mStart;
+    }
+    void sweep(VRle &rle);
+    void discard();
+
+private:
+    VPointF toPoint(const SW_FT_Vector &pt) const
+    {
+        return {pt.x / 64.0f - mOrigin.x(), pt.y / 64.0f - mOrigin.y()};
+    }
+    bool outside(const VPointF *pts, int count) const
+    {
+        bool above = true, below = true;
+        for (int i = 0; i < count; i++) {
+            above = above && pts[i].y() < 0;
+            below = below && pts[i].y() >= mHeight;
+        }
+        return above || below;
+    }
+    void line(const VPointF &p0, const VPointF &p1);
+    void clampedLine(float x0, float y0, float x1, float y1);
+    void accumulate(int y, float x0, float x1, float d);
+    void touch(int y, int x0, int x1);
+    void clearRow(int y);
+    uint8_t coverage(float area) const;
+
+    VPoint    mOrigin;
+    int       mWidth;
+    int       mHeight;
+    int       mStride;
+    int       mWordStride;
+    bool      mEvenOdd;
+    float     mCubicFlat;
+    float     mConicFlat;
+    float *   mCells{nullptr};
+    uint64_t *mTouched{nullptr};
+    int *     mMinX{nullptr};
+    int *     mMaxX{nullptr};
+    VPointF   mStart;
+    VPointF   mCurrent;
+};
+
+/*
+ * Curves are flattened with the same criteria as gray_render_conic() and
+ * gray_render_cubic() so that both backends produce the same polyline.
+ */
+void AccumRaster::conicTo(const SW_FT_Vector &ctrl, const SW_FT_Vector &pt)
+{
+    const VPointF p0 = mCurrent;
+    const VPointF p1 = toPoint(ctrl);
+    const VPointF p2 = toPoint(pt);
+    const VPointF pts[3] = {p0, p1, p2};
+
+    if (outside(pts, 3)) {
+        mCurrent = p2;
+        return;
+    }
+
+    float dev = std::max(std::fabs(p0.x() + p2.x() - 2 * p1.x()),
+                         std::fabs(p0.y() + p2.y() - 2 * p1.y()));
+    int   n = 1;
+    while (dev > mConicFlat && n < (1 << MaxCurveLevel)) {
+        dev /= 4;
+        n <<= 1;
+    }
+
+    const float step = 1.0f / n;
+    for (int i = 1; i < n; i++) {
+        const float   t = i * step;
+        const float   mt = 1.0f - t;
+        const VPointF p = mt * mt * p0 + 2.0f * mt * t * p1 + t * t * p2;
+        line(mCurrent, p);
+        mCurrent = p;
+    }
+    line(mCurrent, p2);
+    mCurrent = p2;
+}
+
+void AccumRaster::cubicTo(const SW_FT_Vector &ctrl1, const SW_FT_Vector &ctrl2,
+                          const SW_FT_Vector &pt)
+{
+    VPointF  stack[3 * MaxCurveLevel + 4];
+    VPointF *arc = stack;
+
+    // arc is stored end to start, same as the freetype bezier stack.
+    arc[0] = toPoint(pt);
+    arc[1] = toPoint(ctrl2);
+    arc[2] = toPoint(ctrl1);
+    arc[3] = mCurrent;
+
+    if (outside(arc, 4)) {
+        mCurrent = arc[0];
+        return;
+    }
+
+    const float flat = mCubicFlat;
+    for (;;) {
+        // control points converge towards the chord trisection points,
+        // draw once they are within the flatness tolerance of them.
+        if (arc != stack + 3 * MaxCurveLevel &&
+            (std::fabs(2 * arc[0].x() - 3 * arc[1].x() + arc[3].x()) > flat ||
+             std::fabs(2 * arc[0].y() - 3 * arc[1].y() + arc[3].y()) > flat ||
+             std::fabs(arc[0].x() - 3 * arc[2].x() + 2 * arc[3].x()) > flat ||
+             std::fabs(arc[0].y() - 3 * arc[2].y() + 2 * arc[3].y()) > flat)) {
+            // split the arc in two halves (de casteljau)
+            arc[6] = arc[3];
+            VPointF a = arc[0] + arc[1];
+            VPointF b = arc[1] + arc[2];
+            VPointF c = arc[2] + arc[3];
+            arc[5] = c * 0.5f;
+            c += b;
+            arc[4] = c * 0.25f;
+            arc[1] = a * 0.5f;
+            a += b;
+            arc[2] = a * 0.25f;
+            arc[3] = (a + c) * 0.125f;
+            arc += 3;
+            continue;
+        }
+
+        line(mCurrent, arc[0]);
+        mCurrent = arc[0];
+
+        if (arc == stack) return;
+        arc -= 3;
+    }
+}
+
+void AccumRaster::line(const VPointF &p0, const VPointF &p1)
+{
+    if (p0.y() == p1.y()) return;
+
+    // split the edge where it crosses the left and right border, the parts
+    // outside collapse onto the border and only carry the winding for the
+    // rest of the scanline.
+    const float w = float(mWidth);
+    const float dx = p1.x() - p0.x();
+    float       t[4] = {0.0f};
+    int         n = 1;
+    if ((p0.x() < 0) != (p1.x() < 0)) t[n++] = -p0.x() / dx;
+    if ((p0.x() > w) != (p1.x() > w)) t[n++] = (w - p0.x()) / dx;
+    if (n == 3 && t[1] > t[2]) std::swap(t[1], t[2]);
+    t[n] = 1.0f;
+
+    VPointF from = p0;
+    for (int i = 1; i <= n; i++) {
+        VPointF to = i == n ? p1 : p0 + (p1 - p0) * t[i];
+        clampedLine(std::min(std::max(from.x(), 0.0f), w), from.y(),
+                    std::min(std::max(to.x(), 0.0f), w), to.y());
+        from = to;
+    }
+}
+
+void AccumRaster::clampedLine(float x0, float y0, float x1, float y1)
+{
+    if (y0 == y1) return;
+
+    float dir = 1.0f;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        dir = -1.0f;
+    }
+
+    if (y1 <= 0 || y0 >= mHeight) return;
+
+    const float dxdy = (x1 - x0) / (y1 - y0);
+    float       x = x0;
+    if (y0 < 0) {
+        x -= y0 * dxdy;
+        y0 = 0;
+    }
+    if (y1 > mHeight) y1 = float(mHeight);
+
+    const int yEnd = int(std::ceil(y1));
+    for (int y = int(y0); y < yEnd; y++) {
+        const float dy = std::min(float(y + 1), y1) - std::max(float(y), y0);
+        // guard the float error so the cell index stays inside the row.
+        const float xNext = std::min(std::max(x + dxdy * dy, 0.0f),
+                                     float(mWidth));
+        accumulate(y, std::min(x, xNext), std::max(x, xNext), dy * dir);
+        x = xNext;
+    }
+}
+
+void AccumRaster::touch(int y, int x0, int x1)
+{
+    uint64_t *words = mTouched + size_t(y) * mWordStride;
+    for (int x = x0; x <= x1;) {
+        const int      bit = x & 63;
+        const int      count = std::min(64 - bit, x1 - x + 1);
+        const uint64_t mask =
+            (count == 64 ? ~uint64_t(0) : ((uint64_t(1) << count) - 1)) << bit;
+        words[x >> 6] |= mask;
+        x += count;
+    }
+    mMinX[y] = std::min(mMinX[y], x0);
+    mMaxX[y] = std::max(mMaxX[y], x1);
+}
+
+void AccumRaster::accumulate(int y, float x0, float x1, float d)
+{
+    float *     row = mCells + size_t(y) * mStride;
+    const float x0floor = std::floor(x0);
+    const int   x0i = int(x0floor);
+    const float x1ceil = std::ceil(x1);
+    const int   x1i = int(x1ceil);
+
+    if (x1i <= x0i + 1) {
+        // edge stays inside a single pixel
+        const float xmf = 0.5f * (x0 + x1) - x0floor;
+        row[x0i] += d - d * xmf;
+        row[x0i + 1] += d * xmf;
+        touch(y, x0i, x0i + 1);
+        return;
+    }
+
+    const float s = 1.0f / (x1 - x0);
+    const float x0f = x0 - x0floor;
+    const float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+    const float x1f = x1 - x1ceil + 1.0f;
+    const float am = 0.5f * s * x1f * x1f;
+
+    row[x0i] += d * a0;
+    if (x1i == x0i + 2) {
+        row[x0i + 1] += d * (1.0f - a0 - am);
+    } else {
+        const float a1 = s * (1.5f - x0f);
+        row[x0i + 1] += d * (a1 - a0);
+        for (int xi = x0i + 2; xi < x1i - 1; xi++) row[xi] += d * s;
+        const float a2 = a1 + (x1i - x0i - 3) * s;
+        row[x1i - 1] += d * (1.0f - a2 - am);
+    }
+    row[x1i] += d * am;
+    touch(y, x0i, x1i);
+}
+
+// same coverage mapping as gray_hline() so both backends match.
+uint8_t AccumRaster::coverage(float area) const
+{
+    int cov = int(std::fabs(area) * 256.0f);
+    if (mEvenOdd) {
+        cov &= 511;
+        if (cov > 256)
+            cov = 512 - cov;
+        else if (cov == 256)
+            cov = 255;
+    } else if (cov >= 256) {
+        cov = 255;
+    }
+    return uint8_t(cov);
+}
+
+void AccumRaster::sweep(VRle &rle)
+{
+    constexpr int MaxSpans = 256;
+    VRle::Span    spans[MaxSpans];
+    int           count = 0;
+    int           left = INT_MAX, top = INT_MAX;
+    int           right = INT_MIN, bottom = INT_MIN;
+
+    for (int y = 0; y < mHeight; y++) {
+        if (mMaxX[y] < 0) continue;
+
+        float *    row = mCells + size_t(y) * mStride;
+        uint64_t * words = mTouched + size_t(y) * mWordStride;
+        const int  lastX = mWidth - 1;
+        float      acc = 0.0f;
+        int        spanStart = 0;
+        uint8_t    spanCov = 0;
+
+        auto flush = [&](int end) {
+            if (!spanCov || end <= spanStart) return;
+            if (count == MaxSpans) {
+                rle.addSpan(spans, count);
+                count = 0;
+            }
+            auto &span = spans[count++];
+            span.x = short(mOrigin.x() + spanStart);
+            span.y = short(mOrigin.y() + y);
+            span.len = uint16_t(end - spanStart);
+            span.coverage = spanCov;
+            left = std::min(left, int(span.x));
+            right = std::max(right, span.x + int(span.len));
+            top = std::min(top, int(span.y));
+            bottom = std::max(bottom, int(span.y));
+        };
+
+        // only the touched cells change the coverage, the pixels in
+        // between share the coverage of the previous touched cell.
+        for (int w = mMinX[y] >> 6, end = mMaxX[y] >> 6; w <= end; w++) {
+            uint64_t word = words[w];
+            words[w] = 0;
+            while (word) {
+                const int x = (w << 6) + lowestBit(word);
+                word &= word - 1;
+
+                acc += row[x];
+                row[x] = 0.0f;
+                if (x > lastX) continue;
+
+                const uint8_t cov = coverage(acc);
+                if (cov != spanCov) {
+                    flush(x);
+                    spanStart = x;
+                    spanCov = cov;
+                }
+            }
+        }
+        flush(lastX + 1);
+
+        mMinX[y] = INT_MAX;
+        mMaxX[y] = -1;
+    }
+
+    if (count) rle.addSpan(spans, count);
+    if (right > left)
+        rle.setBoundingRect({left, top, right - left, bottom - top + 1});
+}
+
+void AccumRaster::discard()
+{
+    for (int y = 0; y < mHeight; y++) {
+        if (mMaxX[y] < 0) continue;
+        float *   row = mCells + size_t(y) * mStride;
+        uint64_t *words = mTouched + size_t(y) * mWordStride;
+        std::fill(row + mMinX[y], row + mMaxX[y] + 1, 0.0f);
+        std::fill(words + (mMinX[y] >> 6), words + (mMaxX[y] >> 6) + 1, 0);
+        mMinX[y] = INT_MAX;
+        mMaxX[y] = -1;
+    }
+}
+
+static bool decompose(const SW_FT_Outline &outline, AccumRaster &raster)
+{
+    const SW_FT_Vector *points = outline.points;
+    const char *        tags = outline.tags;
+
+    int first = 0;
+    for (int n = 0; n < outline.n_contours; n++) {
+        const int last = outline.contours[n];
+        if (last < first) return false;
+
+        // our outlines always start a contour with an on-curve point.
+        if (SW_FT_CURVE_TAG(tags[first]) != SW_FT_CURVE_TAG_ON) return false;
+
+        raster.moveTo(points[first]);
+
+        int i = first + 1;
+        while (i <= last) {
+            switch (SW_FT_CURVE_TAG(tags[i])) {
+            case SW_FT_CURVE_TAG_ON:
+                raster.lineTo(points[i]);
+                i++;
+                break;
+            case SW_FT_CURVE_TAG_CONIC: {
+                SW_FT_Vector ctrl = points[i++];
+                // consecutive conic controls imply an on-curve midpoint.
+                while (i <= last &&
+                       SW_FT_CURVE_TAG(tags[i]) == SW_FT_CURVE_TAG_CONIC) {
+                    SW_FT_Vector mid;
+                    mid.x = (ctrl.x + points[i].x) / 2;
+                    mid.y = (ctrl.y + points[i].y) / 2;
+                    raster.conicTo(ctrl, mid);
+                    ctrl = points[i++];
+                }
+                if (i <= last) {
+                    raster.conicTo(ctrl, points[i++]);
+                } else {
+                    raster.conicTo(ctrl, points[first]);
+                }
+                break;
+            }
+            default:  // SW_FT_CURVE_TAG_CUBIC
+                if (i + 1 > last ||
+                    SW_FT_CURVE_TAG(tags[i + 1]) != SW_FT_CURVE_TAG_CUBIC)
+                    return false;
+                if (i + 2 <= last) {
+                    raster.cubicTo(points[i], points[i + 1], points[i + 2]);
+                } else {
+                    raster.cubicTo(points[i], points[i + 1], points[first]);
+                }
+                i += 3;
+                break;
+            }
+        }
+        raster.close();
+        first = last + 1;
+    }
+    return true;
+}
+
+bool vRasterAccumulate(const SW_FT_Outline &outline, const VRect &clip,
+                       float flatness, VRle &rle)
+{
+    if (outline.n_points <= 0 || outline.n_contours <= 0) return true;
+
+    // outline bounding box truncated to integer pixels
+    SW_FT_Pos xMin = outline.points[0].x, xMax = xMin;
+    SW_FT_Pos yMin = outline.points[0].y, yMax = yMin;
+    for (int i = 1; i < outline.n_points; i++) {
+        xMin = std::min(xMin, outline.points[i].x);
+        xMax = std::max(xMax, outline.points[i].x);
+        yMin = std::min(yMin, outline.points[i].y);
+        yMax = std::max(yMax, outline.points[i].y);
+    }
+
+    VRect region = clip.empty() ? VRect(-32768, -32768, 65535, 65535) : clip;
+    int   left = std::max(int(xMin >> 6), region.left());
+    int   top = std::max(int(yMin >> 6), region.top());
+    int   right = std::min(int((xMax + 63) >> 6), region.right());
+    int   bottom = std::min(int((yMax + 63) >> 6), region.bottom());
+
+    if (left >= right || top >= bottom) return true;
+
+    if (size_t(right - left + 2) * size_t(bottom - top) > MaxAccumCells)
+        return false;
+
+    AccumRaster raster(Accum_Buffer, {left, top, right - left, bottom - top},
+                       outline.flags & SW_FT_OUTLINE_EVEN_ODD_FILL, flatness);
+
+    if (!decompose(outline, raster)) {
+        raster.discard();
+        return false;
+    }
+
+    raster.sweep(rle);
+    return true;
+}
+
+V_END_NAMESPACE
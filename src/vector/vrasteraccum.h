@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2020 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef VRASTERACCUM_H
+#define VRASTERACCUM_H
+
+#include "v_ft_raster.h"
+#include "vglobal.h"
+#include "vrect.h"
+
+V_BEGIN_NAMESPACE
+
+class VRle;
+
+/*
+ * Signed area accumulation rasterizer.
+ *
+ * Every edge of the outline deposits its signed coverage into a per
+ * scanline accumulation buffer, a prefix sum over each row then gives
+ * the final coverage. Only the touched range of each row is swept, so
+ * the cost is proportional to the covered area instead of the cell
+ * bookkeeping done by the gray raster.
+ *
+ * Takes the same 26.6 outline as sw_ft_grays_raster and honours
+ * SW_FT_OUTLINE_EVEN_ODD_FILL. Curves are flattened to within flatness
+ * pixels, same criteria as the gray raster. Returns false if the outline
+ * is too large for the accumulation buffer, caller should fall back to
+ * the gray raster in that case.
+ */
+bool vRasterAccumulate(const SW_FT_Outline &outline, const VRect &clip,
+                       float flatness, VRle &rle);
+
+V_END_NAMESPACE
+
+#endif  // VRASTERACCUM_H
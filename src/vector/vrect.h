@@ -61,6 +61,7 @@ public:
     friend VDebug &                operator<<(VDebug &os, const VRect &o);
 
     VRect intersected(const VRect &r) const;
+    VRect united(const VRect &r) const;
     VRect operator&(const VRect &r) const;
 
 private:
@@ -75,6 +76,20 @@ inline VRect VRect::intersected(const VRect &r) const
     return *this & r;
 }
 
+// smallest rect containing both, an empty rect contributes nothing
+inline VRect VRect::united(const VRect &r) const
+{
+    if (empty()) return r;
+    if (r.empty()) return *this;
+
+    VRect result;
+    result.x1 = x1 < r.x1 ? x1 : r.x1;
+    result.y1 = y1 < r.y1 ? y1 : r.y1;
+    result.x2 = x2 > r.x2 ? x2 : r.x2;
+    result.y2 = y2 > r.y2 ? y2 : r.y2;
+    return result;
+}
+
 inline bool VRect::intersects(const VRect &r)
 {
     return (right() > r.left() && left() < r.right() && bottom() > r.top() &&
@@ -95,8 +95,8 @@ void VRle::Data::translate(const VPoint &p)
         i.x = i.x + x;
         i.y = i.y + y;
     }
-    updateBbox();
-    mBbox.translate(mOffset.x(), mOffset.y());
+    // a dirty box is computed from the moved spans later.
+    if (!mBboxDirty) mBbox.translate(x, y);
 }
 
 void VRle::Data::addRect(const VRect &rect)
@@ -149,6 +149,29 @@ void VRle::Data::operator*=(uint8_t alpha)
     }
 }
 
+bool VRle::Data::covers(const VRect &r) const
+{
+    if (r.empty()) return true;
+    if (!bbox().contains(r)) return false;
+
+    // first span of the top row
+    auto span = std::lower_bound(
+        mSpans.cbegin(), mSpans.cend(), r.top(),
+        [](const VRle::Span &s, int y) { return s.y < y; });
+
+    for (int y = r.top(); y < r.bottom(); y++) {
+        int x = r.left();
+        for (; span != mSpans.cend() && span->y == y; ++span) {
+            if (x >= r.right() || span->x + span->len <= x) continue;
+            // a gap or a partially covered pixel inside the rect
+            if (span->x > x || span->coverage != 255) return false;
+            x = span->x + span->len;
+        }
+        if (x < r.right()) return false;
+    }
+    return true;
+}
+
 void VRle::Data::opIntersect(const VRect &r, VRle::VRleSpanCb cb,
                              void *userData) const
 {
@@ -223,15 +246,15 @@ void VRle::Data::opGeneric(const VRle::Data &aObj, const VRle::Data &bObj,
     // reserve some space for the result vector.
     mSpans.reserve(a.size() + b.size());
 
-    // if two rle are disjoint
-    if (!aObj.bbox().intersects(bObj.bbox())) {
-        if (a.data()[0].y < b.data()[0].y) {
-            copy(a.data(), a.size(), mSpans);
-            copy(b.data(), b.size(), mSpans);
-        } else {
-            copy(b.data(), b.size(), mSpans);
-            copy(a.data(), a.size(), mSpans);
-        }
+    // if two rle don't share a scanline the spans can be appended, rle
+    // that are only disjoint horizontally still need the merge to keep
+    // the spans sorted by y.
+    if (a.data()[a.size() - 1].y < b.data()[0].y) {
+        copy(a.data(), a.size(), mSpans);
+        copy(b.data(), b.size(), mSpans);
+    } else if (b.data()[b.size() - 1].y < a.data()[0].y) {
+        copy(b.data(), b.size(), mSpans);
+        copy(a.data(), a.size(), mSpans);
     } else {
         auto aPtr = a.data();
         auto aEnd = a.data() + a.size();
@@ -300,7 +323,7 @@ void VRle::Data::opIntersect(VRle::View a, VRle::View b)
         if (count) copy(result.data(), count, mSpans);
     }
 
-    updateBbox();
+    mBboxDirty = true;
 }
 
 static void _opIntersect(rle_view a, rle_view b, VRle::VRleSpanCb cb,
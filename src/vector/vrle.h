@@ -53,6 +53,8 @@ public:
     void translate(const VPoint &p) { d.write().translate(p); }
 
     void operator*=(uint8_t alpha) { d.write() *= alpha; }
+    // true if every pixel of the rect has full coverage.
+    bool covers(const VRect &r) const { return d->covers(r); }
 
     void intersect(const VRect &r, VRleSpanCb cb, void *userData) const;
     void intersect(const VRle &rle, VRleSpanCb cb, void *userData) const;
@@ -92,6 +94,7 @@ public:
         void  reset();
         void  translate(const VPoint &p);
         void  operator*=(uint8_t alpha);
+        bool  covers(const VRect &r) const;
         void  opGeneric(const VRle::Data &, const VRle::Data &, Op code);
         void  opSubstract(const VRle::Data &, const VRle::Data &);
         void  opIntersect(VRle::View a, VRle::View b);
@@ -0,0 +1,143 @@
+/*
+ * Base64 decoder test
+ *
+ * Runs the decoder used for embedded images (SIMD blocks when the cpu
+ * has them) against the table decoder on encoded payloads of every
+ * length, with padding, line breaks, url safe and invalid characters
+ * mixed in, starting at every offset of a 16 byte block. The output
+ * must match byte for byte and stay inside base64DecodedSize().
+ *
+ * Usage:
+ *   lottie_base64_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "lottiemodel.h"
+
+using namespace rlottie::internal;
+
+/* Small xorshift, the test must see the same input on every run */
+static uint32_t next_random(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static const char Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Characters the vector blocks don't take, they fall back to the table */
+static const char Other[] = "-_\n\r \t=.,:!\x80\xff";
+
+enum Damage { Clean, Padded, Stray };
+
+/* An encoded payload of length characters */
+static std::vector<char> make_input(uint32_t* state, size_t length,
+                                    Damage damage)
+{
+    std::vector<char> input(length);
+    for (size_t i = 0; i < length; i++)
+        input[i] = Alphabet[next_random(state) & 63];
+
+    if (damage == Padded && length) {
+        input[length - 1] = '=';
+        if (length > 1 && (next_random(state) & 1)) input[length - 2] = '=';
+    } else if (damage == Stray && length) {
+        int count = 1 + int(next_random(state) % 3);
+        for (int n = 0; n < count; n++) {
+            input[next_random(state) % length] =
+                Other[next_random(state) % (sizeof(Other) - 1)];
+        }
+    }
+    return input;
+}
+
+static int check_decode(uint32_t* state, size_t length, size_t offset,
+                        Damage damage)
+{
+    /* guard bytes behind the output catch a store past the end */
+    const size_t  guard = 16;
+    const uint8_t fill = 0xA5;
+
+    std::vector<char> input = make_input(state, length, damage);
+    /* copy to the wanted offset so the loads are unaligned */
+    std::vector<char> buffer(offset + length + 1);
+    memcpy(buffer.data() + offset, input.data(), length);
+    const char* data = buffer.data() + offset;
+
+    size_t size = model::base64DecodedSize(length);
+    std::vector<uint8_t> expected(size + guard, fill);
+    std::vector<uint8_t> result(size + guard, fill);
+
+    size_t expectedLength = model::base64DecodeScalar(data, length,
+                                                      expected.data());
+    size_t resultLength = model::base64Decode(data, length, result.data());
+
+    static const char* names[] = {"clean", "padded", "stray"};
+    if (resultLength != expectedLength || resultLength > size) {
+        printf("  %s length %zu offset %zu: decoded %zu bytes, expected %zu "
+               "(at most %zu)\n", names[damage], length, offset, resultLength,
+               expectedLength, size);
+        return 1;
+    }
+    for (size_t i = 0; i < size + guard; i++) {
+        if (result[i] == expected[i]) continue;
+        printf("  %s length %zu offset %zu byte %zu: %02x, expected %02x%s\n",
+               names[damage], length, offset, i, result[i], expected[i],
+               i >= size ? " (past the end)" : "");
+        return 1;
+    }
+    return 0;
+}
+
+/* A known payload, so the table decoder itself is checked too */
+static int check_known()
+{
+    static const char encoded[] =
+        "TG9yZW0gaXBzdW0gZG9sb3Igc2l0IGFtZXQsIGNvbnNlY3RldHVyIGFkaXBpc2Npbmc=";
+    static const char decoded[] =
+        "Lorem ipsum dolor sit amet, consectetur adipiscing";
+    const size_t length = sizeof(encoded) - 1;
+
+    std::vector<uint8_t> out(model::base64DecodedSize(length));
+    size_t size = model::base64Decode(encoded, length, out.data());
+    if (size != sizeof(decoded) - 1 || memcmp(out.data(), decoded, size)) {
+        printf("  known payload: decoded %zu bytes \"%.*s\"\n", size,
+               int(size), reinterpret_cast<const char*>(out.data()));
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    const size_t maxLength = 300;
+    uint32_t     state = 0x6A09E667;
+    int          failures = 0;
+
+    printf("Checking base64 decoding...\n");
+    failures += check_known();
+    for (size_t length = 0; length <= maxLength; length++) {
+        for (size_t offset = 0; offset < 16; offset++) {
+            failures += check_decode(&state, length, offset, Clean);
+            failures += check_decode(&state, length, offset, Padded);
+            failures += check_decode(&state, length, offset, Stray);
+        }
+    }
+
+    if (failures) {
+        printf("  FAILED: %d payloads differ\n", failures);
+        return 1;
+    }
+    printf("  OK\n");
+    return 0;
+}
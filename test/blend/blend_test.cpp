@@ -0,0 +1,163 @@
+/*
+ * Blend function test
+ *
+ * Runs the blend functions and texture fetchers selected for this cpu
+ * (SSE2 when available) against the portable formulas, for spans that
+ * start and end off the 4 pixel blocks the vector loops work on.
+ *
+ * Usage:
+ *   lottie_blend_test
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "vdrawhelper.h"
+
+/* Small xorshift, the test must see the same pixels on every run */
+static uint32_t next_random(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/* A premultiplied pixel, mostly opaque or transparent like a matte */
+static uint32_t random_pixel(uint32_t* state)
+{
+    uint32_t r = next_random(state);
+    uint32_t a;
+    switch (r & 3) {
+    case 0: a = 0; break;
+    case 1:
+    case 2: a = 255; break;
+    default: a = (r >> 8) & 0xFF; break;
+    }
+    uint32_t c = next_random(state);
+    return (a << 24) | (((c >> 16) & 0xFF) * a / 255) << 16 |
+           (((c >> 8) & 0xFF) * a / 255) << 8 | ((c & 0xFF) * a / 255);
+}
+
+/* dest * luma of src, faded by const_alpha, see src_LumaIn() */
+static uint32_t luma_reference(uint32_t dest, uint32_t src,
+                               uint32_t const_alpha, bool invert)
+{
+    uint32_t a = vLuma(src);
+    if (invert) a = 255 - a;
+    if (const_alpha != 255) a = BYTE_MUL(a, const_alpha) + 255 - const_alpha;
+    return BYTE_MUL(dest, a);
+}
+
+static int check_luma(const RenderFuncTable& table, BlendMode mode,
+                      bool invert)
+{
+    const int maxLength = 19;
+    /* 16 byte aligned so offset 0 starts on a vector block */
+    alignas(16) uint32_t dest[maxLength + 4];
+    uint32_t src[maxLength + 4];
+    uint32_t expected[maxLength + 4];
+    uint32_t state = 0x9E3779B9;
+    int failures = 0;
+
+    for (uint32_t const_alpha = 0; const_alpha <= 255; const_alpha++) {
+        for (int offset = 0; offset < 4; offset++) {
+            for (int length = 1; length <= maxLength; length++) {
+                for (int i = 0; i < length; i++) {
+                    dest[offset + i] = random_pixel(&state);
+                    src[offset + i] = random_pixel(&state);
+                    expected[i] = luma_reference(dest[offset + i],
+                                                 src[offset + i],
+                                                 const_alpha, invert);
+                }
+                table.src(mode)(dest + offset, length, src + offset,
+                                const_alpha);
+                for (int i = 0; i < length; i++) {
+                    if (dest[offset + i] == expected[i]) continue;
+                    if (failures++ < 8) {
+                        printf("  %s const_alpha %u offset %d length %d "
+                               "pixel %d: %08x, expected %08x\n",
+                               invert ? "LumaOut" : "LumaIn", const_alpha,
+                               offset, length, i, dest[offset + i],
+                               expected[i]);
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+/* The texel fetch_nearest() reads, see blend_image_xform() */
+static uint32_t nearest_reference(const VTextureData& src, int x, float sx,
+                                  float ox, float sy, float oy)
+{
+    int px = int(float(x) * sx + ox);
+    int py = int(float(x) * sy + oy);
+    px = px < src.left ? src.left : px > src.right ? src.right : px;
+    py = py < src.top ? src.top : py > src.bottom ? src.bottom : py;
+    return src.pixel(px, py);
+}
+
+static int check_fetch_nearest()
+{
+    const int size = 37;
+    const int maxLength = 19;
+    VBitmap   bitmap(size, size, VBitmap::Format::ARGB32_Premultiplied);
+    uint32_t  state = 0x2545F491;
+    int       failures = 0;
+
+    for (int y = 0; y < size; y++) {
+        auto row = reinterpret_cast<uint32_t*>(bitmap.data() +
+                                               y * bitmap.stride());
+        for (int x = 0; x < size; x++) row[x] = next_random(&state);
+    }
+
+    VTextureData src;
+    src.prepare(&bitmap);
+    src.setClip(VRect(2, 3, size - 6, size - 4));
+
+    uint32_t dest[maxLength];
+    for (int n = 0; n < 2000; n++) {
+        /* rotated and sheared steps, the positions run past the clip */
+        const float sx = (int(next_random(&state) % 401) - 200) / 100.0f;
+        const float sy = (int(next_random(&state) % 401) - 200) / 100.0f;
+        const float ox = (int(next_random(&state) % 8001) - 4000) / 100.0f;
+        const float oy = (int(next_random(&state) % 8001) - 4000) / 100.0f;
+        const int   x = int(next_random(&state) % 64);
+        const int   length = 1 + int(next_random(&state) % maxLength);
+
+        fetch_nearest(dest, src, x, length, sx, ox, sy, oy);
+        for (int i = 0; i < length; i++) {
+            uint32_t expected = nearest_reference(src, x + i, sx, ox, sy, oy);
+            if (dest[i] == expected) continue;
+            if (failures++ < 8) {
+                printf("  fetch_nearest x %d length %d pixel %d: %08x, "
+                       "expected %08x\n", x, length, i, dest[i], expected);
+            }
+        }
+    }
+    return failures;
+}
+
+int main()
+{
+    RenderFuncTable table;
+    int failures = 0;
+
+    printf("Checking luma matte blending...\n");
+    failures += check_luma(table, BlendMode::LumaIn, false);
+    failures += check_luma(table, BlendMode::LumaOut, true);
+
+    printf("Checking nearest texture fetch...\n");
+    failures += check_fetch_nearest();
+
+    if (failures) {
+        printf("  FAILED: %d pixels differ\n", failures);
+        return 1;
+    }
+    printf("  OK\n");
+    return 0;
+}
@@ -154,6 +154,13 @@ int main(int argc, char* argv[])
     lottie_animation_get_size(anim, &width, &height);
     printf("   get_size:        %zu x %zu\n", width, height);
     printf("   frame_at_pos(0.5): %zu\n", lottie_animation_frame_at_pos(anim, 0.5));
+    {
+        LottieAnimationStats stats;
+        ret = lottie_animation_get_stats(anim, &stats);
+        printf("   get_stats:       %d layers, %d offscreen, frames %zu-%zu\n",
+               (int)stats.layerCount, (int)stats.offscreenLayerCount,
+               stats.activeInFrame, stats.activeOutFrame);
+    }
     printf("   OK\n\n");
     
     /* Test: Render frame */
@@ -179,7 +186,14 @@ int main(int argc, char* argv[])
         lottie_animation_destroy(anim);
         return 1;
     }
-    printf("   OK: Frame rendered\n\n");
+    printf("   OK: Frame rendered\n");
+    {
+        LottieRenderStats renderStats;
+        ret = lottie_animation_get_render_stats(anim, &renderStats);
+        printf("   get_render_stats: %d drawn, %d culled\n\n",
+               (int)renderStats.drawnLayerCount,
+               (int)renderStats.culledLayerCount);
+    }
     
     /* Test: Save BMP */
     if (argc >= 3) {
@@ -223,6 +237,51 @@ int main(int argc, char* argv[])
         /* This should not crash */
         lottie_animation_destroy(nullHandle);
         printf("   destroy(NULL): OK (no crash)\n");
+        
+        ret = lottie_configure_rasterizer(-1);
+        printf("   configure_rasterizer(-1): %d (expected %d)\n", ret, LOTTIE_ERR_INVALID);
+        
+        ret = lottie_configure_easing(-1);
+        printf("   configure_easing(-1): %d (expected %d)\n", ret, LOTTIE_ERR_INVALID);
+        
+        printf("   backends: rasterizer %d, easing %d (unchanged)\n",
+               lottie_get_rasterizer(), lottie_get_easing());
+        
+        ret = lottie_configure_image_decode(-1);
+        printf("   configure_image_decode(-1): %d (expected %d)\n", ret, LOTTIE_ERR_INVALID);
+        
+        ret = lottie_animation_get_stats(nullHandle, NULL);
+        printf("   get_stats(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_animation_render_time(nullHandle, 0.0, NULL, 1);
+        printf("   render_time(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_animation_bake_timeline(nullHandle, NULL);
+        printf("   bake_timeline(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_animation_set_quality(nullHandle, LOTTIE_QUALITY_FAST);
+        printf("   set_quality(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_animation_set_image_filter(nullHandle, LOTTIE_IMAGE_FILTER_NEAREST);
+        printf("   set_image_filter(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_animation_get_render_stats(nullHandle, NULL);
+        printf("   get_render_stats(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_get_surface_cache_stats(NULL);
+        printf("   get_surface_cache_stats(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        ret = lottie_parser_feed(NULL, "{", 1);
+        printf("   parser_feed(NULL): %d (expected %d)\n", ret, LOTTIE_ERR_NULL);
+        
+        printf("   parser_finish(NULL): %p (expected NULL)\n",
+               (void*)lottie_parser_finish(NULL));
+        
+        ret = lottie_animation_set_quality(anim, -1);
+        printf("   set_quality(-1): %d (expected %d)\n", ret, LOTTIE_ERR_INVALID);
+        
+        ret = lottie_animation_set_image_filter(anim, -1);
+        printf("   set_image_filter(-1): %d (expected %d)\n", ret, LOTTIE_ERR_INVALID);
         printf("   OK\n\n");
     }
     
@@ -230,6 +289,8 @@ int main(int argc, char* argv[])
     printf("8. Cleanup...\n");
     free(buffer);
     lottie_animation_destroy(anim);
+    lottie_purge_image_cache();
+    lottie_purge_surface_cache();
     printf("   OK\n\n");
     
     printf("=== All C API tests passed! ===\n");
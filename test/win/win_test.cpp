@@ -5,9 +5,18 @@
  * 1. Load Lottie JSON file
  * 2. Render all frames and save as BMP files
  * 3. Optional: Play animation using GDI
+ * 4. Optional: Compare rasterizer / easing backends (timing + pixel diff)
  * 
  * Usage:
- *   lottie_test <input.json> [output_dir] [--play]
+ *   lottie_test <input.json> [output_dir] [--play] [--raster gray|accum]
+ *               [--quality auto|high|normal|fast] [--scale <factor>] [--bake]
+ *               [--filter nearest|bilinear]
+ *               [--fps <rate>] [--decode lazy|parallel] [--stream <kb>]
+ *   lottie_test <input.json> --compare-raster
+ *   lottie_test <input.json> --compare-easing
+ *   lottie_test <input.json> --check-order
+ *   lottie_test <input.json> --bench
+ *   lottie_test <input.json> --compare-to <reference.json>
  */
 
 #include <stdio.h>
@@ -46,15 +55,117 @@ static double get_time_ms() {
 /* Print usage */
 static void print_usage(const char* program) {
     printf("Lottie Renderer Test Program\n\n");
-    printf("Usage: %s <input.json> [output_dir] [--play]\n\n", program);
+    printf("Usage: %s <input.json> [output_dir] [--play] [--raster gray|accum]\n", program);
+    printf("                 [--quality auto|high|normal|fast] [--scale <factor>] [--bake]\n");
+    printf("                 [--filter nearest|bilinear]\n");
+    printf("                 [--fps <rate>] [--decode lazy|parallel] [--stream <kb>]\n");
+    printf("       %s <input.json> --compare-raster\n", program);
+    printf("       %s <input.json> --compare-easing\n", program);
+    printf("       %s <input.json> --check-order\n", program);
+    printf("       %s <input.json> --bench\n", program);
+    printf("       %s <input.json> --compare-to <reference.json>\n\n", program);
     printf("Arguments:\n");
-    printf("  input.json   Lottie JSON animation file\n");
-    printf("  output_dir   Output directory (default: ./output)\n");
-    printf("  --play       Play animation using GDI (Windows only)\n");
+    printf("  input.json       Lottie JSON animation file\n");
+    printf("  output_dir       Output directory (default: ./output)\n");
+    printf("  --play           Play animation using GDI (Windows only)\n");
+    printf("  --raster         Rasterizer backend: gray or accum\n");
+    printf("  --quality        Curve flattening quality (default: auto)\n");
+    printf("  --scale          Scale the output size, e.g. 0.25 for thumbnails\n");
+    printf("  --filter         Sampling of scaled image layers (default: nearest)\n");
+    printf("  --bake           Pre-evaluate animated properties for every frame\n");
+    printf("  --fps            Render by time at this output rate, e.g. 120\n");
+    printf("  --decode         Decode images on first use or all at load in parallel\n");
+    printf("  --stream         Load through the incremental parser in chunks of this many KB\n");
+    printf("  --compare-raster Benchmark both rasterizers and diff their output\n");
+    printf("  --compare-easing Benchmark exact and table easing and diff their output\n");
+    printf("  --check-order    Check that frames don't depend on the render order\n");
+    printf("  --bench          Time the frames forwards and backwards without saving\n");
+    printf("  --compare-to     Diff the output against a reference animation\n");
     printf("\nExamples:\n");
     printf("  %s animation.json\n", program);
     printf("  %s animation.json ./frames\n", program);
     printf("  %s animation.json --play\n", program);
+    printf("  %s animation.json ./thumbs --scale 0.25 --quality fast\n", program);
+    printf("  %s animation.json ./frames --scale 2 --filter bilinear\n", program);
+    printf("  %s animation.json ./frames --bake\n", program);
+    printf("  %s animation.json ./frames --fps 120\n", program);
+    printf("  %s animation.json ./frames --decode parallel\n", program);
+    printf("  %s animation.json ./frames --stream 16\n", program);
+    printf("  %s animation.json --compare-raster\n", program);
+    printf("  %s animation.json --compare-easing\n", program);
+    printf("  %s animation.json --check-order\n", program);
+    printf("  %s animation.json --bench --fps 120\n", program);
+    printf("  %s animation.json --compare-to reference.json\n", program);
+}
+
+/* Load the file through the incremental parser, chunkSize bytes at a time */
+static LottieAnimationHandle load_streamed(const char* path, size_t chunkSize) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    
+    /* External images are looked up next to the JSON file */
+    std::string dir(path);
+    size_t slash = dir.find_last_of("/\\");
+    dir = (slash == std::string::npos) ? std::string() : dir.substr(0, slash + 1);
+    
+    LottieParserHandle parser = lottie_parser_create(dir.c_str());
+    if (!parser) {
+        fclose(fp);
+        return NULL;
+    }
+    
+    std::string chunk(chunkSize, '\0');
+    size_t read;
+    while ((read = fread(&chunk[0], 1, chunkSize, fp)) > 0) {
+        lottie_parser_feed(parser, chunk.data(), read);
+    }
+    fclose(fp);
+    
+    return lottie_parser_finish(parser);
+}
+
+/* Content summary, the numbers a scheduler would use to predict cost */
+static void print_stats(LottieAnimationHandle anim) {
+    LottieAnimationStats stats;
+    if (lottie_animation_get_stats(anim, &stats) != LOTTIE_OK) return;
+    
+    printf("Content:\n");
+    printf("  Layers: %zu (shape %zu, precomp %zu, image %zu, solid %zu, hidden %zu)\n",
+           stats.layerCount, stats.shapeLayerCount, stats.precompLayerCount,
+           stats.imageLayerCount, stats.solidLayerCount, stats.hiddenLayerCount);
+    printf("  Static: %zu layers%s\n", stats.staticLayerCount,
+           stats.isStatic ? " (whole animation)" : "");
+    printf("  Mattes: %zu, Masks: %zu, Offscreen: %zu\n",
+           stats.matteLayerCount, stats.maskLayerCount, stats.offscreenLayerCount);
+    printf("  Paths: %zu (%zu unique, largest %zu points, %.1f KB shared)\n",
+           stats.pathCount, stats.uniquePathCount, stats.maxPathPoints,
+           stats.sharedPathBytes / 1024.0);
+    if (stats.hasContent) {
+        printf("  Active Frames: %zu - %zu\n", stats.activeInFrame, stats.activeOutFrame);
+    } else {
+        printf("  Active Frames: none\n");
+    }
+}
+
+/*
+ * Number of frames to render. With an output rate the frames are
+ * rendered by time, in between animation frames the keyframes are
+ * interpolated.
+ */
+static size_t output_frame_count(const LottieAnimationInfo* info, double fps) {
+    if (fps > 0) return (size_t)(info->duration * fps + 1e-6) + 1;
+    return info->totalFrames;
+}
+
+/* Render output frame n, see output_frame_count() */
+static int render_frame(
+    LottieAnimationHandle anim,
+    size_t frame,
+    double fps,
+    LottieSurface* surface)
+{
+    return fps > 0 ? lottie_animation_render_time(anim, frame / fps, surface, 1)
+                   : lottie_animation_render(anim, frame, surface, 1);
 }
 
 /* Render all frames and save as BMP */
@@ -62,7 +173,8 @@ static int render_to_files(
     LottieAnimationHandle anim,
     const char* outputDir,
     size_t width,
-    size_t height)
+    size_t height,
+    double fps)
 {
     LottieAnimationInfo info;
     if (lottie_animation_get_info(anim, &info) != LOTTIE_OK) {
@@ -76,6 +188,11 @@ static int render_to_files(
     printf("  Duration: %.2f sec\n", info.duration);
     printf("  Original Size: %zu x %zu\n", info.width, info.height);
     printf("  Render Size: %zu x %zu\n", width, height);
+    
+    size_t frameCount = output_frame_count(&info, fps);
+    if (fps > 0) {
+        printf("  Output Rate: %.2f fps (%zu frames)\n", fps, frameCount);
+    }
     printf("\n");
     
     /* Create output directory */
@@ -100,16 +217,25 @@ static int render_to_files(
     double startTime = get_time_ms();
     
     /* Render each frame */
-    for (size_t frame = 0; frame < info.totalFrames; frame++) {
+    size_t drawnLayers = 0;
+    size_t culledLayers = 0;
+    for (size_t frame = 0; frame < frameCount; frame++) {
         /* Clear buffer */
         memset(buffer, 0, bufferSize);
         
         /* Render frame */
-        if (lottie_animation_render(anim, frame, &surface, 1) != LOTTIE_OK) {
+        int ret = render_frame(anim, frame, fps, &surface);
+        if (ret != LOTTIE_OK) {
             fprintf(stderr, "Warning: Failed to render frame %zu\n", frame);
             continue;
         }
         
+        LottieRenderStats frameStats;
+        if (lottie_animation_get_render_stats(anim, &frameStats) == LOTTIE_OK) {
+            drawnLayers += frameStats.drawnLayerCount;
+            culledLayers += frameStats.culledLayerCount;
+        }
+        
         /* Generate filename */
         char filename[512];
         snprintf(filename, sizeof(filename), "%s/frame_%04zu.bmp", outputDir, frame);
@@ -121,10 +247,10 @@ static int render_to_files(
         }
         
         /* Progress display */
-        if ((frame + 1) % 10 == 0 || frame == info.totalFrames - 1) {
+        if ((frame + 1) % 10 == 0 || frame == frameCount - 1) {
             printf("\r  Progress: %zu / %zu (%.1f%%)", 
-                   frame + 1, info.totalFrames,
-                   (frame + 1) * 100.0 / info.totalFrames);
+                   frame + 1, frameCount,
+                   (frame + 1) * 100.0 / frameCount);
             fflush(stdout);
         }
     }
@@ -133,11 +259,369 @@ static int render_to_files(
     double elapsed = endTime - startTime;
     
     printf("\n\nRendering Complete!\n");
-    printf("  Total Frames: %zu\n", info.totalFrames);
+    printf("  Total Frames: %zu\n", frameCount);
     printf("  Time: %.2f sec\n", elapsed / 1000.0);
-    printf("  Average: %.2f ms/frame\n", elapsed / info.totalFrames);
+    printf("  Average: %.2f ms/frame\n", elapsed / frameCount);
     printf("  Output Dir: %s\n", outputDir);
     
+    LottieSurfaceCacheStats pool;
+    if (lottie_get_surface_cache_stats(&pool) == LOTTIE_OK &&
+        pool.allocations + pool.reuses > 0) {
+        printf("  Offscreen: %zu allocated, %zu reused, peak %.1f KB\n",
+               pool.allocations, pool.reuses, pool.peakBytes / 1024.0);
+    }
+    if (culledLayers > 0) {
+        printf("  Culled: %zu of %zu layers (beneath opaque layers)\n",
+               culledLayers, drawnLayers + culledLayers);
+    }
+    
+    free(buffer);
+    return 0;
+}
+
+/* A pair of library level backends to compare */
+typedef struct {
+    const char* what;             /* "rasterizer", "easing mode" */
+    int (*configure)(int);        /* lottie_configure_xxx() */
+    int first, second;            /* backends to compare */
+    const char* firstName;
+    const char* secondName;
+    int (*current)(void);         /* lottie_get_xxx(), restored afterwards */
+    int loadTime;                 /* applied while loading, not rendering */
+} BackendPair;
+
+static const BackendPair RasterPair = {
+    "rasterizer", lottie_configure_rasterizer,
+    LOTTIE_RASTER_GRAY, LOTTIE_RASTER_ACCUM, "gray ", "accum",
+    lottie_get_rasterizer, 0
+};
+
+static const BackendPair EasingPair = {
+    "easing mode", lottie_configure_easing,
+    LOTTIE_EASING_EXACT, LOTTIE_EASING_TABLE, "exact", "table",
+    lottie_get_easing, 1
+};
+
+/*
+ * Curves are flattened independently, so a few edge pixels may differ
+ * more than the tolerance. Only fail when that happens to more than
+ * 0.01% of the pixels.
+ */
+typedef struct {
+    size_t pixels;          /* Compared pixels */
+    size_t differing;
+    size_t overTolerance;
+    int maxDiff;
+} DiffStats;
+
+static const int DiffTolerance = 8;
+
+static void diff_frame(const uint32_t* first, const uint32_t* second,
+                       size_t count, DiffStats* stats)
+{
+    stats->pixels += count;
+    for (size_t i = 0; i < count; i++) {
+        if (first[i] == second[i]) continue;
+        int pixelDiff = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            int a = (first[i] >> shift) & 0xFF;
+            int b = (second[i] >> shift) & 0xFF;
+            int d = a > b ? a - b : b - a;
+            if (d > pixelDiff) pixelDiff = d;
+        }
+        stats->differing++;
+        if (pixelDiff > DiffTolerance) stats->overTolerance++;
+        if (pixelDiff > stats->maxDiff) stats->maxDiff = pixelDiff;
+    }
+}
+
+/* Print the diff, returns -1 when too many pixels are over tolerance */
+static int report_diff(const DiffStats* stats, const char* what)
+{
+    double pixels = stats->pixels ? (double)stats->pixels : 1.0;
+    printf("  Differing pixels: %zu (%.4f%%)\n", stats->differing,
+           stats->differing * 100.0 / pixels);
+    printf("  Over tolerance %d: %zu (%.4f%%)\n", DiffTolerance,
+           stats->overTolerance, stats->overTolerance * 100.0 / pixels);
+    printf("  Max channel diff: %d\n", stats->maxDiff);
+
+    if (stats->overTolerance * 10000 > stats->pixels) {
+        printf("  FAILED: %s output mismatch\n", what);
+        return -1;
+    }
+    printf("  OK\n");
+    return 0;
+}
+
+/*
+ * Render every frame with both backends of the pair.
+ * Each backend gets its own animation handle so that both of them
+ * rasterize every frame instead of reusing the other's result.
+ */
+static int compare_backends(
+    const BackendPair* pair,
+    const char* inputFile,
+    LottieAnimationHandle anim,
+    size_t width,
+    size_t height)
+{
+    const int previous = pair->current();
+
+    /*
+     * Load time settings apply to the model, load the second handle
+     * with the second backend. The model cache keeps one model per
+     * easing mode, so this gets its own model even with the cache on.
+     */
+    if (pair->loadTime) pair->configure(pair->second);
+    LottieAnimationHandle other = lottie_animation_from_file(inputFile);
+    if (pair->loadTime) pair->configure(previous);
+    if (!other) {
+        fprintf(stderr, "Error: Cannot load animation file '%s'\n", inputFile);
+        return -1;
+    }
+
+    size_t totalFrames = lottie_animation_get_totalframe(anim);
+    size_t count = width * height;
+    uint32_t* first = (uint32_t*)malloc(count * sizeof(uint32_t));
+    uint32_t* second = (uint32_t*)malloc(count * sizeof(uint32_t));
+    if (!first || !second) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(first);
+        free(second);
+        lottie_animation_destroy(other);
+        return -1;
+    }
+
+    LottieSurface firstSurface = {first, width, height, width * sizeof(uint32_t)};
+    LottieSurface secondSurface = {second, width, height, width * sizeof(uint32_t)};
+
+    double firstTime = 0, secondTime = 0;
+    DiffStats diff = {0, 0, 0, 0};
+
+    printf("Comparing %ss (%zu frames, %zu x %zu)...\n",
+           pair->what, totalFrames, width, height);
+
+    for (size_t frame = 0; frame < totalFrames; frame++) {
+        memset(first, 0, count * sizeof(uint32_t));
+        memset(second, 0, count * sizeof(uint32_t));
+
+        pair->configure(pair->first);
+        double t0 = get_time_ms();
+        lottie_animation_render(anim, frame, &firstSurface, 1);
+        double t1 = get_time_ms();
+
+        pair->configure(pair->second);
+        lottie_animation_render(other, frame, &secondSurface, 1);
+        double t2 = get_time_ms();
+
+        firstTime += t1 - t0;
+        secondTime += t2 - t1;
+
+        diff_frame(first, second, count, &diff);
+    }
+
+    pair->configure(previous);
+
+    printf("  %s: %.2f ms/frame\n", pair->firstName, firstTime / totalFrames);
+    printf("  %s: %.2f ms/frame (%.2fx)\n", pair->secondName,
+           secondTime / totalFrames,
+           secondTime > 0 ? firstTime / secondTime : 0.0);
+    free(first);
+    free(second);
+    lottie_animation_destroy(other);
+
+    return report_diff(&diff, pair->what);
+}
+
+/*
+ * Render every frame of the animation and of a reference file that is
+ * expected to look the same, e.g. the same content built without the
+ * feature under test.
+ */
+static int compare_to_reference(
+    const char* referenceFile,
+    LottieAnimationHandle anim,
+    size_t width,
+    size_t height)
+{
+    LottieAnimationHandle reference = lottie_animation_from_file(referenceFile);
+    if (!reference) {
+        fprintf(stderr, "Error: Cannot load animation file '%s'\n", referenceFile);
+        return -1;
+    }
+
+    size_t totalFrames = lottie_animation_get_totalframe(anim);
+    size_t count = width * height;
+    uint32_t* first = (uint32_t*)malloc(count * sizeof(uint32_t));
+    uint32_t* second = (uint32_t*)malloc(count * sizeof(uint32_t));
+    if (!first || !second) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(first);
+        free(second);
+        lottie_animation_destroy(reference);
+        return -1;
+    }
+
+    LottieSurface firstSurface = {first, width, height, width * sizeof(uint32_t)};
+    LottieSurface secondSurface = {second, width, height, width * sizeof(uint32_t)};
+    DiffStats diff = {0, 0, 0, 0};
+
+    printf("Comparing with %s (%zu frames, %zu x %zu)...\n",
+           referenceFile, totalFrames, width, height);
+
+    for (size_t frame = 0; frame < totalFrames; frame++) {
+        memset(first, 0, count * sizeof(uint32_t));
+        memset(second, 0, count * sizeof(uint32_t));
+        lottie_animation_render(anim, frame, &firstSurface, 1);
+        lottie_animation_render(reference, frame, &secondSurface, 1);
+        diff_frame(first, second, count, &diff);
+    }
+
+    free(first);
+    free(second);
+    lottie_animation_destroy(reference);
+
+    return report_diff(&diff, "reference");
+}
+
+/* FNV-1a over the pixels of a frame */
+static uint64_t frame_hash(const uint32_t* pixels, size_t count) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < count; i++) {
+        hash ^= pixels[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/*
+ * Render every frame forwards with one handle and backwards with a
+ * fresh one. A frame must not depend on the frames drawn before it.
+ * With an output rate the frames fall in between animation frames.
+ */
+static int check_render_order(
+    const char* inputFile,
+    LottieAnimationHandle anim,
+    size_t width,
+    size_t height,
+    double fps)
+{
+    LottieAnimationHandle other = lottie_animation_from_file(inputFile);
+    if (!other) {
+        fprintf(stderr, "Error: Cannot load animation file '%s'\n", inputFile);
+        return -1;
+    }
+
+    LottieAnimationInfo info;
+    if (lottie_animation_get_info(anim, &info) != LOTTIE_OK) {
+        fprintf(stderr, "Error: Cannot get animation info\n");
+        lottie_animation_destroy(other);
+        return -1;
+    }
+
+    size_t totalFrames = output_frame_count(&info, fps);
+    size_t count = width * height;
+    uint32_t* buffer = (uint32_t*)malloc(count * sizeof(uint32_t));
+    uint64_t* hashes = (uint64_t*)malloc(totalFrames * sizeof(uint64_t));
+    if (!buffer || !hashes) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        free(buffer);
+        free(hashes);
+        lottie_animation_destroy(other);
+        return -1;
+    }
+
+    LottieSurface surface = {buffer, width, height, width * sizeof(uint32_t)};
+
+    printf("Checking render order (%zu frames, %zu x %zu)...\n",
+           totalFrames, width, height);
+
+    for (size_t frame = 0; frame < totalFrames; frame++) {
+        render_frame(anim, frame, fps, &surface);
+        hashes[frame] = frame_hash(buffer, count);
+    }
+
+    size_t mismatch = 0;
+    for (size_t frame = totalFrames; frame-- > 0;) {
+        render_frame(other, frame, fps, &surface);
+        if (frame_hash(buffer, count) != hashes[frame]) mismatch++;
+    }
+
+    free(buffer);
+    free(hashes);
+    lottie_animation_destroy(other);
+
+    printf("  Frames differing between forward and backward: %zu\n", mismatch);
+    if (mismatch) {
+        printf("  FAILED: output depends on the render order\n");
+        return -1;
+    }
+    printf("  OK\n");
+    return 0;
+}
+
+/* Render every frame in order, without saving, and time each one */
+static void time_pass(
+    LottieAnimationHandle anim,
+    size_t frameCount,
+    double fps,
+    LottieSurface* surface,
+    int backward)
+{
+    double total = 0;
+    double slowest = 0;
+    size_t slowestFrame = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        size_t frame = backward ? frameCount - 1 - i : i;
+        memset(surface->buffer, 0, surface->bytesPerLine * surface->height);
+        double t0 = get_time_ms();
+        render_frame(anim, frame, fps, surface);
+        double elapsed = get_time_ms() - t0;
+        total += elapsed;
+        if (elapsed > slowest) {
+            slowest = elapsed;
+            slowestFrame = frame;
+        }
+    }
+    printf("  %-9s %.3f ms/frame, slowest frame %zu (%.3f ms)\n",
+           backward ? "Backward:" : "Forward:", total / frameCount,
+           slowestFrame, slowest);
+}
+
+/*
+ * Time the frames forwards, as played, and backwards, where every frame
+ * seeks back across the layers' in and out points.
+ */
+static int time_frames(
+    LottieAnimationHandle anim,
+    size_t width,
+    size_t height,
+    double fps)
+{
+    LottieAnimationInfo info;
+    if (lottie_animation_get_info(anim, &info) != LOTTIE_OK) {
+        fprintf(stderr, "Error: Cannot get animation info\n");
+        return -1;
+    }
+
+    size_t frameCount = output_frame_count(&info, fps);
+    uint32_t* buffer = (uint32_t*)malloc(width * height * sizeof(uint32_t));
+    if (!buffer) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return -1;
+    }
+
+    LottieSurface surface = {buffer, width, height, width * sizeof(uint32_t)};
+
+    printf("Timing %zu frames, %zu x %zu...\n", frameCount, width, height);
+
+    /* the first pass also builds the layer tree and caches, don't count it */
+    for (size_t frame = 0; frame < frameCount; frame++) {
+        render_frame(anim, frame, fps, &surface);
+    }
+    time_pass(anim, frameCount, fps, &surface, 0);
+    time_pass(anim, frameCount, fps, &surface, 1);
+
     free(buffer);
     return 0;
 }
@@ -367,11 +851,97 @@ int main(int argc, char* argv[]) {
     const char* inputFile = argv[1];
     const char* outputDir = "output";
     int playMode = 0;
+    const BackendPair* compare = NULL;
+    int quality = LOTTIE_QUALITY_AUTO;
+    int filter = LOTTIE_IMAGE_FILTER_NEAREST;
+    double scale = 1.0;
+    int bake = 0;
+    int checkOrder = 0;
+    int bench = 0;
+    const char* referenceFile = NULL;
+    double fps = 0;
+    size_t streamChunk = 0;
     
     /* Parse arguments */
     for (int i = 2; i < argc; i++) {
         if (strcmp(argv[i], "--play") == 0) {
             playMode = 1;
+        } else if (strcmp(argv[i], "--compare-raster") == 0) {
+            compare = &RasterPair;
+        } else if (strcmp(argv[i], "--compare-easing") == 0) {
+            compare = &EasingPair;
+        } else if (strcmp(argv[i], "--check-order") == 0) {
+            checkOrder = 1;
+        } else if (strcmp(argv[i], "--bench") == 0) {
+            bench = 1;
+        } else if (strcmp(argv[i], "--compare-to") == 0 && i + 1 < argc) {
+            referenceFile = argv[++i];
+        } else if (strcmp(argv[i], "--raster") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "accum") == 0) {
+                lottie_configure_rasterizer(LOTTIE_RASTER_ACCUM);
+            } else if (strcmp(argv[i], "gray") == 0) {
+                lottie_configure_rasterizer(LOTTIE_RASTER_GRAY);
+            } else {
+                fprintf(stderr, "Error: Unknown rasterizer '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--quality") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "auto") == 0) {
+                quality = LOTTIE_QUALITY_AUTO;
+            } else if (strcmp(argv[i], "high") == 0) {
+                quality = LOTTIE_QUALITY_HIGH;
+            } else if (strcmp(argv[i], "normal") == 0) {
+                quality = LOTTIE_QUALITY_NORMAL;
+            } else if (strcmp(argv[i], "fast") == 0) {
+                quality = LOTTIE_QUALITY_FAST;
+            } else {
+                fprintf(stderr, "Error: Unknown quality '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "nearest") == 0) {
+                filter = LOTTIE_IMAGE_FILTER_NEAREST;
+            } else if (strcmp(argv[i], "bilinear") == 0) {
+                filter = LOTTIE_IMAGE_FILTER_BILINEAR;
+            } else {
+                fprintf(stderr, "Error: Unknown filter '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            scale = atof(argv[++i]);
+            if (scale <= 0.0) {
+                fprintf(stderr, "Error: Invalid scale '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            fps = atof(argv[++i]);
+            if (fps <= 0.0) {
+                fprintf(stderr, "Error: Invalid output rate '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--decode") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "lazy") == 0) {
+                lottie_configure_image_decode(LOTTIE_IMAGE_DECODE_LAZY);
+            } else if (strcmp(argv[i], "parallel") == 0) {
+                lottie_configure_image_decode(LOTTIE_IMAGE_DECODE_PARALLEL);
+            } else {
+                fprintf(stderr, "Error: Unknown decode mode '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--stream") == 0 && i + 1 < argc) {
+            double kb = atof(argv[++i]);
+            if (kb <= 0) {
+                fprintf(stderr, "Error: Invalid chunk size '%s'\n", argv[i]);
+                return 1;
+            }
+            streamChunk = (size_t)(kb * 1024);
+            if (streamChunk == 0) streamChunk = 1;
+        } else if (strcmp(argv[i], "--bake") == 0) {
+            bake = 1;
         } else if (argv[i][0] != '-') {
             outputDir = argv[i];
         }
@@ -380,11 +950,16 @@ int main(int argc, char* argv[]) {
     printf("Loading animation: %s\n", inputFile);
     
     /* Load animation */
-    LottieAnimationHandle anim = lottie_animation_from_file(inputFile);
+    double loadStart = get_time_ms();
+    LottieAnimationHandle anim = streamChunk
+        ? load_streamed(inputFile, streamChunk)
+        : lottie_animation_from_file(inputFile);
     if (!anim) {
         fprintf(stderr, "Error: Cannot load animation file '%s'\n", inputFile);
         return 1;
     }
+    printf("Loaded in %.2f ms\n", get_time_ms() - loadStart);
+    print_stats(anim);
     
     /* Get animation size */
     size_t width = 0, height = 0;
@@ -400,20 +975,63 @@ int main(int argc, char* argv[]) {
         height = 1080;
     }
     
+    /* Thumbnail / upscaled output */
+    if (scale != 1.0) {
+        width = (size_t)(width * scale);
+        height = (size_t)(height * scale);
+        if (width == 0) width = 1;
+        if (height == 0) height = 1;
+    }
+    
+    lottie_animation_set_quality(anim, quality);
+    lottie_animation_set_image_filter(anim, filter);
+    
+    if (bake) {
+        size_t bakedBytes = 0;
+        double t0 = get_time_ms();
+        lottie_animation_bake_timeline(anim, &bakedBytes);
+        printf("Baked timeline: %.1f KB in %.2f ms\n",
+               bakedBytes / 1024.0, get_time_ms() - t0);
+    }
+    
     int result = 0;
     
+    if (compare) {
+        result = compare_backends(compare, inputFile, anim, width, height);
+        lottie_animation_destroy(anim);
+        return result == 0 ? 0 : 1;
+    }
+
+    if (checkOrder) {
+        result = check_render_order(inputFile, anim, width, height, fps);
+        lottie_animation_destroy(anim);
+        return result == 0 ? 0 : 1;
+    }
+
+    if (bench) {
+        result = time_frames(anim, width, height, fps);
+        lottie_animation_destroy(anim);
+        return result == 0 ? 0 : 1;
+    }
+
+    if (referenceFile) {
+        result = compare_to_reference(referenceFile, anim, width, height);
+        lottie_animation_destroy(anim);
+        return result == 0 ? 0 : 1;
+    }
+    
 #ifdef _WIN32
     if (playMode) {
         printf("Play mode (Press ESC to exit)\n");
         result = play_animation(anim, width, height);
     } else {
-        result = render_to_files(anim, outputDir, width, height);
+        result = render_to_files(anim, outputDir, width, height, fps);
     }
 #else
     if (playMode) {
         printf("Warning: Play mode only supported on Windows\n");
     }
-    result = render_to_files(anim, outputDir, width, height);
+    result = render_to_files(anim, outputDir, width, height, fps);
 #endif
     
     /* Test serialization */
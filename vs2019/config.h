@@ -15,4 +15,7 @@
 /* Module loading support (optional) */
 /* #define LOTTIE_MODULE_SUPPORT 1 */
 
+/* Accumulation rasterizer as default backend (optional) */
+/* #define LOTTIE_ACCUM_RASTER_SUPPORT 1 */
+
 #endif /* LOTTIE_RENDERER_CONFIG_H */